@@ -128,7 +128,7 @@ void setup()
 #endif
 
 	serialMessageListeners[0] = (SerialMessageAdapter::SerialMessageListener*) &serialMessageAdapter;
-	serialMessageAdapter.setListeners(serialMessageListeners);
+	serialMessageAdapter.setListeners(serialMessageListeners, membersof(serialMessageListeners));
 
 	networkSerial.initSerial();
 }
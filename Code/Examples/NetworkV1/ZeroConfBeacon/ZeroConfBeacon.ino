@@ -194,7 +194,7 @@ void setup()
 	
 	//Begin: Init some structures
 	serialMessageListeners[0] = &zeroConfSerial;
-	serialMessageAdapter.setListeners(serialMessageListeners);
+	serialMessageAdapter.setListeners(serialMessageListeners, membersof(serialMessageListeners));
 	//End: Init some structures
 
 	readConfig();
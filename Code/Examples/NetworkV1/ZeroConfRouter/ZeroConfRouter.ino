@@ -189,7 +189,7 @@ void setup()
 #endif
 	
 	serialMessageListeners[0] = &zeroConfSerial;
-	serialMessageAdapter.setListeners(serialMessageListeners);
+	serialMessageAdapter.setListeners(serialMessageListeners, membersof(serialMessageListeners));
 
 	readConfig();
 
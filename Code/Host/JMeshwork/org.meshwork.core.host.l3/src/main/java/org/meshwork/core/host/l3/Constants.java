@@ -96,6 +96,16 @@ public interface Constants {
     public static final byte ERROR_NO_KNOWN_ROUTES = -40;
     /** Rerouting a message has failed. */
     public static final byte ERROR_REROUTE_FAILED = -41;
+    /** A relay has reported a broken link on the route. */
+    public static final byte ERROR_ROUTE_BROKEN = -42;
+
+    //Send errors subCode group
+    /** Driver send has failed. */
+    public static final byte ERROR_DRIVER_SEND_FAILED = -51;
+    /** Send aborted by the app. */
+    public static final byte ERROR_DRIVER_SEND_ABORTED = -52;
+    /** No free slot for another asynchronous send. */
+    public static final byte ERROR_SEND_QUEUE_FULL = -53;
 
     /** First possible node ID. */
     public static final byte MIN_NODE_ID 	= 1;
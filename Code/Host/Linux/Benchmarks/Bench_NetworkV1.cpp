@@ -0,0 +1,298 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+/**
+ * NetworkV1 throughput and latency benchmark over SimMedium in
+ * virtual time. For each delivery method and hop count a line of
+ * nodes is built (originator, hop count relays, destination) and the
+ * originator sends a fixed number of messages with NetworkV1::send();
+ * the other nodes run NetworkV1::recv() loops.
+ *
+ * Reported per scenario:
+ *   msgs/s		delivered messages per virtual second of the send phase
+ *   p50/p95/p99	latency from send() to recv() at the destination, ms
+ *   retries/msg	radio retransmissions per delivered message
+ *   frames/msg		frames sent by all nodes (data, ACKs, relays, L3
+ *					resends) per delivered message
+ *   air/B			airtime per delivered payload byte, us
+ *
+ * A scenario that delivers no message at all is reported on stderr
+ * and makes the benchmark exit with 1.
+ *
+ * Usage: Bench_NetworkV1 [-n messages] [-l loss] [-p payload] [-H hops] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Cosa/Types.h"
+#include "Cosa/RTC.hh"
+#include "Meshwork.h"
+#include "Meshwork/L3/Network.h"
+#include "Meshwork/L3/NetworkV1/NetworkV1.h"
+#include "Simulation/SimMedium.h"
+#include "Simulation/SimRadioDriver.h"
+#include "Simulation/SimScheduler.h"
+
+using Meshwork::L3::Network;
+using Meshwork::L3::NetworkV1::NetworkV1;
+using Meshwork::Simulation::SimMedium;
+using Meshwork::Simulation::SimRadioDriver;
+using Meshwork::Simulation::SimScheduler;
+
+#define BENCH_NETWORK_ID	0xC05A
+#define BENCH_PORT			10
+#define BENCH_FIRST_NODE	1
+#define BENCH_MSG_MAX		10000
+//scenario, message index (2)
+#define BENCH_HEADER_LEN	3
+#define BENCH_SETTLE_MS		20000
+
+//Line route from the originator through all nodes up to dst
+class LineRouteProvider: public NetworkV1::RouteProvider {
+protected:
+	NetworkV1::route_t m_route;
+	uint8_t m_hops[NetworkV1::MAX_ROUTING_HOPS];
+	uint8_t m_src;
+
+public:
+	LineRouteProvider(): m_src(BENCH_FIRST_NODE) {
+		m_route.hops = m_hops;
+	}
+
+	void set_address(uint8_t src) {
+		m_src = src;
+	}
+
+	uint8_t get_routeCount(uint8_t dst) {
+		return dst > m_src && dst - m_src - 1 <= NetworkV1::MAX_ROUTING_HOPS ? 1 : 0;
+	}
+
+	NetworkV1::route_t* get_route(uint8_t dst, uint8_t index) {
+		if ( index >= get_routeCount(dst) )
+			return NULL;
+		m_route.src = m_src;
+		m_route.dst = dst;
+		m_route.hopCount = dst - m_src - 1;
+		for ( uint8_t i = 0; i < m_route.hopCount; i ++ )
+			m_hops[i] = m_src + 1 + i;
+		return &m_route;
+	}
+
+	void route_found(NetworkV1::route_t* route) {
+		UNUSED(route);
+	}
+
+	void route_failed(NetworkV1::route_t* route) {
+		UNUSED(route);
+	}
+};
+
+struct node_t {
+	SimRadioDriver* rf;
+	NetworkV1* nwk;
+};
+
+struct scenario_t {
+	uint8_t delivery;
+	uint8_t hops;
+	uint16_t sent;
+	uint16_t delivered;
+	uint64_t elapsed;	//us, send phase
+	uint32_t p50, p95, p99;	//us
+	SimMedium::stats_t stats;
+};
+
+static SimScheduler scheduler;
+static SimMedium medium;
+static LineRouteProvider routes;
+static node_t nodes[NetworkV1::MAX_ROUTING_HOPS + 2];
+
+static uint8_t s_scenario = 0;
+static uint64_t s_start[BENCH_MSG_MAX];
+static uint64_t s_arrival[BENCH_MSG_MAX];
+static uint32_t s_latency[BENCH_MSG_MAX];
+
+static void* receiver(void* arg) {
+	node_t* node = (node_t*) arg;
+	for ( ;; ) {
+		uint8_t src, port;
+		uint8_t data[NetworkV1::PAYLOAD_MAX];
+		size_t len = sizeof(data);
+		int result = node->nwk->recv(src, port, data, len, 0, NULL);
+		if ( result != Network::OK || port != BENCH_PORT || len < BENCH_HEADER_LEN || data[0] != s_scenario )
+			continue;
+		uint16_t index = data[1] | (data[2] << 8);
+		if ( index < BENCH_MSG_MAX && s_arrival[index] == 0 )
+			s_arrival[index] = scheduler.get_micros();
+	}
+	return NULL;
+}
+
+static int compare_latency(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*) a;
+	uint32_t y = *(const uint32_t*) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+//nearest-rank percentile of a sorted array
+static uint32_t percentile(uint32_t* sorted, uint16_t count, uint8_t p) {
+	if ( count == 0 )
+		return 0;
+	uint32_t rank = ((uint32_t) p * count + 99) / 100;
+	return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+static void run(scenario_t* sc, uint16_t count, uint8_t payload, float loss) {
+	uint8_t dst = BENCH_FIRST_NODE + sc->hops + 1;
+	medium.disconnect_all();
+	medium.connect_line(BENCH_FIRST_NODE, sc->hops + 2, loss);
+	s_scenario ++;
+	for ( uint16_t i = 0; i < count; i ++ )
+		s_start[i] = s_arrival[i] = 0;
+	medium.reset_stats();
+
+	NetworkV1* nwk = nodes[0].nwk;
+	uint8_t data[NetworkV1::PAYLOAD_MAX];
+	for ( uint8_t i = 0; i < payload; i ++ )
+		data[i] = i;
+	data[0] = s_scenario;
+	uint64_t begin = scheduler.get_micros();
+	for ( uint16_t i = 0; i < count; i ++ ) {
+		data[1] = i & 0xff;
+		data[2] = i >> 8;
+		size_t lenACK = 0;
+		s_start[i] = scheduler.get_micros();
+		nwk->send(sc->delivery, NetworkV1::DEFAULT_SEND_RETRY, dst, BENCH_PORT, data, payload, NULL, lenACK);
+	}
+	sc->sent = count;
+	sc->elapsed = scheduler.get_micros() - begin;
+
+	//let late frames (relays, ACKs) drain before reading the statistics
+	Meshwork::Time::delay(BENCH_SETTLE_MS);
+	medium.get_stats_total(sc->stats);
+
+	sc->delivered = 0;
+	for ( uint16_t i = 0; i < count; i ++ )
+		if ( s_arrival[i] != 0 )
+			s_latency[sc->delivered ++] = (uint32_t) (s_arrival[i] - s_start[i]);
+	qsort(s_latency, sc->delivered, sizeof(s_latency[0]), compare_latency);
+	sc->p50 = percentile(s_latency, sc->delivered, 50);
+	sc->p95 = percentile(s_latency, sc->delivered, 95);
+	sc->p99 = percentile(s_latency, sc->delivered, 99);
+}
+
+static const char* delivery_name(uint8_t delivery) {
+	switch ( delivery ) {
+		case Network::DELIVERY_DIRECT: return "DIRECT";
+		case Network::DELIVERY_ROUTED: return "ROUTED";
+		case Network::DELIVERY_FLOOD: return "FLOOD";
+	}
+	return "?";
+}
+
+static void print(scenario_t* sc, uint8_t payload) {
+	float seconds = sc->elapsed / 1000000.0f;
+	float delivered = sc->delivered;
+	if ( sc->delivered == 0 ) {
+		printf("%-7s %4d %6d %6d %9s %8s %8s %8s %11s %10s %8s\n",
+				delivery_name(sc->delivery), sc->hops, sc->sent, sc->delivered,
+				"-", "-", "-", "-", "-", "-", "-");
+		return;
+	}
+	printf("%-7s %4d %6d %6d %9.1f %8.1f %8.1f %8.1f %11.2f %10.2f %8.1f\n",
+			delivery_name(sc->delivery), sc->hops, sc->sent, sc->delivered,
+			seconds > 0 ? delivered / seconds : 0.0f,
+			sc->p50 / 1000.0f, sc->p95 / 1000.0f, sc->p99 / 1000.0f,
+			sc->stats.tx_retransmits / delivered,
+			sc->stats.tx_frames / delivered,
+			(float) sc->stats.airtime / (delivered * payload));
+}
+
+int main(int argc, char** argv) {
+	uint16_t count = 200;
+	float loss = 0.05f;
+	uint8_t payload = 8;
+	uint8_t maxHops = NetworkV1::MAX_ROUTING_HOPS;
+	uint32_t seed = 1;
+	int opt;
+	while ( (opt = getopt(argc, argv, "n:l:p:H:s:")) != -1 ) {
+		switch ( opt ) {
+			case 'n': count = atoi(optarg); break;
+			case 'l': loss = atof(optarg); break;
+			case 'p': payload = atoi(optarg); break;
+			case 'H': maxHops = atoi(optarg); break;
+			case 's': seed = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "Usage: %s [-n messages] [-l loss] [-p payload] [-H hops] [-s seed]\n", argv[0]);
+				return 1;
+		}
+	}
+	if ( count == 0 || count > BENCH_MSG_MAX || payload < BENCH_HEADER_LEN ||
+			payload > NetworkV1::PAYLOAD_MAX || maxHops > NetworkV1::MAX_ROUTING_HOPS ) {
+		fprintf(stderr, "Invalid arguments: 1 <= messages <= %d, %d <= payload <= %d, hops <= %d\n",
+				BENCH_MSG_MAX, BENCH_HEADER_LEN, NetworkV1::PAYLOAD_MAX, NetworkV1::MAX_ROUTING_HOPS);
+		return 1;
+	}
+
+	medium.set_seed(seed);
+	medium.set_scheduler(&scheduler);
+	scheduler.begin();
+	for ( uint8_t i = 0; i < maxHops + 2; i ++ ) {
+		nodes[i].rf = new SimRadioDriver(&medium, BENCH_NETWORK_ID, BENCH_FIRST_NODE + i);
+		nodes[i].nwk = new NetworkV1(nodes[i].rf, i == 0 ? &routes : NULL);
+		nodes[i].nwk->begin();
+		if ( i > 0 )
+			scheduler.spawn(receiver, &nodes[i]);
+	}
+
+	printf("NetworkV1 benchmark: %d messages, payload %d bytes, link loss %.2f, seed %u\n",
+			count, payload, loss, seed);
+	printf("%-7s %4s %6s %6s %9s %8s %8s %8s %11s %10s %8s\n",
+			"method", "hops", "sent", "deliv", "msgs/s", "p50(ms)", "p95(ms)", "p99(ms)",
+			"retries/msg", "frames/msg", "air/B(us)");
+	static const uint8_t methods[] = { Network::DELIVERY_DIRECT, Network::DELIVERY_ROUTED, Network::DELIVERY_FLOOD };
+	uint8_t failed = 0;
+	for ( uint8_t m = 0; m < sizeof(methods); m ++ ) {
+		//DIRECT only reaches neighbours
+		uint8_t hopsMax = methods[m] == Network::DELIVERY_DIRECT ? 0 : maxHops;
+		for ( uint8_t hops = 0; hops <= hopsMax; hops ++ ) {
+			scenario_t sc;
+			sc.delivery = methods[m];
+			sc.hops = hops;
+			run(&sc, count, payload, loss);
+			print(&sc, payload);
+			fflush(stdout);
+			if ( sc.delivered == 0 ) {
+				fprintf(stderr, "WARNING: %s over %d hops delivered none of %d messages\n",
+						delivery_name(sc.delivery), sc.hops, sc.sent);
+				failed ++;
+			}
+		}
+	}
+	scheduler.end();
+	if ( failed > 0 ) {
+		fprintf(stderr, "FAILED: %d scenario(s) without delivery\n", failed);
+		return 1;
+	}
+	return 0;
+}
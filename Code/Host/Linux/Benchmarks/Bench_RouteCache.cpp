@@ -0,0 +1,150 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+/**
+ * RouteCache lookup and update cost, measured per call on a full
+ * table (MAX_DST_NODES destinations with MAX_DST_ROUTES routes of
+ * MAX_ROUTING_HOPS hops each). Host timings are only comparable with
+ * each other; use them as a baseline for changes to the table layout
+ * and the replacement logic.
+ *
+ * Usage: Bench_RouteCache [-n calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Cosa/Types.h"
+#include "Meshwork/L3/Network.h"
+#include "Meshwork/L3/NetworkV1/NetworkV1.h"
+#include "Meshwork/L3/NetworkV1/RouteCache.h"
+
+using Meshwork::L3::Network;
+using Meshwork::L3::NetworkV1::NetworkV1;
+using Meshwork::L3::NetworkV1::RouteCache;
+
+#define BENCH_SRC		1
+#define BENCH_DST_FIRST	100
+
+static NetworkV1::route_t s_routes[RouteCache::MAX_DST_NODES][RouteCache::MAX_DST_ROUTES];
+static uint8_t s_hops[RouteCache::MAX_DST_NODES][RouteCache::MAX_DST_ROUTES][NetworkV1::MAX_ROUTING_HOPS];
+
+//defeats dead code elimination of the measured calls
+static volatile uintptr_t s_sink;
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void fill(RouteCache* cache) {
+	cache->remove_all();
+	for ( uint8_t i = 0; i < RouteCache::MAX_DST_NODES; i ++ )
+		for ( uint8_t j = 0; j < RouteCache::MAX_DST_ROUTES; j ++ ) {
+			NetworkV1::route_t* route = &s_routes[i][j];
+			route->src = BENCH_SRC;
+			route->dst = BENCH_DST_FIRST + i;
+			route->hopCount = NetworkV1::MAX_ROUTING_HOPS;
+			route->hops = s_hops[i][j];
+			for ( uint8_t k = 0; k < NetworkV1::MAX_ROUTING_HOPS; k ++ )
+				s_hops[i][j][k] = 2 + j + k;
+			cache->add_route_entry(route, false);
+		}
+}
+
+static void report(const char* name, uint64_t start, uint32_t calls) {
+	printf("%-40s %8.1f ns/call\n", name, (double) (now_ns() - start) / calls);
+}
+
+int main(int argc, char** argv) {
+	uint32_t calls = 1000000;
+	int opt;
+	while ( (opt = getopt(argc, argv, "n:")) != -1 ) {
+		switch ( opt ) {
+			case 'n': calls = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "Usage: %s [-n calls]\n", argv[0]);
+				return 1;
+		}
+	}
+	if ( calls == 0 )
+		calls = 1;
+
+	RouteCache cache(NULL);
+	fill(&cache);
+	printf("RouteCache benchmark: %d destinations x %d routes, %d hops, %u calls\n",
+			RouteCache::MAX_DST_NODES, RouteCache::MAX_DST_ROUTES, NetworkV1::MAX_ROUTING_HOPS, calls);
+
+	uint64_t start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.get_route_entry(BENCH_DST_FIRST + n % RouteCache::MAX_DST_NODES,
+													n % RouteCache::MAX_DST_ROUTES);
+	report("get_route_entry(dst, index) hit", start, calls);
+
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.get_route_entry(BENCH_SRC, n % RouteCache::MAX_DST_ROUTES);
+	report("get_route_entry(dst, index) miss", start, calls);
+
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.get_route_entry(&s_routes[n % RouteCache::MAX_DST_NODES][n % RouteCache::MAX_DST_ROUTES]);
+	report("get_route_entry(route) hit", start, calls);
+
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += cache.get_QoS(BENCH_DST_FIRST + n % RouteCache::MAX_DST_NODES, Network::QOS_CALCULATE_AVERAGE);
+	report("get_QoS(dst, AVERAGE)", start, calls);
+
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.add_route_entry(&s_routes[n % RouteCache::MAX_DST_NODES][n % RouteCache::MAX_DST_ROUTES], true);
+	report("add_route_entry existing", start, calls);
+
+	//replace within a full list: alternate between two new routes
+	NetworkV1::route_t extra[2];
+	uint8_t extra_hops[2][NetworkV1::MAX_ROUTING_HOPS];
+	for ( uint8_t i = 0; i < 2; i ++ ) {
+		extra[i].src = BENCH_SRC;
+		extra[i].dst = BENCH_DST_FIRST;
+		extra[i].hopCount = NetworkV1::MAX_ROUTING_HOPS;
+		extra[i].hops = extra_hops[i];
+		for ( uint8_t k = 0; k < NetworkV1::MAX_ROUTING_HOPS; k ++ )
+			extra_hops[i][k] = 200 + i + k;
+	}
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.add_route_entry(&extra[n & 1], true);
+	report("add_route_entry replace route", start, calls);
+
+	//replace a whole destination: alternate between two new destinations
+	fill(&cache);
+	for ( uint8_t i = 0; i < 2; i ++ )
+		extra[i].dst = BENCH_DST_FIRST + RouteCache::MAX_DST_NODES + i;
+	start = now_ns();
+	for ( uint32_t n = 0; n < calls; n ++ )
+		s_sink += (uintptr_t) cache.add_route_entry(&extra[n & 1], true);
+	report("add_route_entry replace destination", start, calls);
+	return 0;
+}
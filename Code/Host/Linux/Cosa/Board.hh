@@ -0,0 +1,64 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_BOARD_HH__
+#define __COSA_BOARD_HH__
+
+/**
+ * Linux host board definition. There is no pin hardware on the host;
+ * the symbols exist so that the pin declarations in the Meshwork
+ * configuration (MW_NRF24L01P_CSN etc) and application headers
+ * still compile. Pin numbers follow the Arduino Mega layout, which
+ * is a superset of the other supported boards.
+ */
+class Board {
+private:
+  Board() {}
+
+public:
+  enum DigitalPin {
+    D0 = 0, D1, D2, D3, D4, D5, D6, D7,
+    D8, D9, D10, D11, D12, D13, D14, D15,
+    D16, D17, D18, D19, D20, D21, D22, D23,
+    D24, D25, D26, D27, D28, D29, D30, D31,
+    D32, D33, D34, D35, D36, D37, D38, D39,
+    D40, D41, D42, D43, D44, D45, D46, D47,
+    D48, D49, D50, D51, D52, D53,
+    LED = D13
+  } __attribute__((packed));
+
+  enum AnalogPin {
+    A0 = 54, A1, A2, A3, A4, A5, A6, A7,
+    A8, A9, A10, A11, A12, A13, A14, A15
+  } __attribute__((packed));
+
+  enum ExternalInterruptPin {
+    EXT0 = D21, EXT1 = D20, EXT2 = D19,
+    EXT3 = D18, EXT4 = D2, EXT5 = D3
+  } __attribute__((packed));
+
+  enum {
+    UART_MAX = 4,
+    EXT_MAX = 6,
+    PCMSK_MAX = 3
+  } __attribute__((packed));
+};
+
+#endif
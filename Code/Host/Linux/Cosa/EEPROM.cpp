@@ -0,0 +1,90 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/EEPROM.hh"
+#include <fcntl.h>
+#include <unistd.h>
+
+EEPROM::Device EEPROM::Device::eeprom;
+
+EEPROM::Device::Device() :
+  m_fd(-1)
+{
+  memset(m_mem, 0xff, sizeof(m_mem));
+}
+
+EEPROM::Device::~Device()
+{
+  end();
+}
+
+bool
+EEPROM::Device::begin(const char* path)
+{
+  end();
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return (false);
+  ssize_t res = pread(fd, m_mem, sizeof(m_mem), 0);
+  if (res != (ssize_t) sizeof(m_mem)) {
+    if (res < 0) res = 0;
+    memset(m_mem + res, 0xff, sizeof(m_mem) - res);
+    if (pwrite(fd, m_mem, sizeof(m_mem), 0) != (ssize_t) sizeof(m_mem)) {
+      close(fd);
+      return (false);
+    }
+  }
+  m_fd = fd;
+  return (true);
+}
+
+bool
+EEPROM::Device::end()
+{
+  if (m_fd < 0) return (true);
+  close(m_fd);
+  m_fd = -1;
+  return (true);
+}
+
+bool
+EEPROM::Device::is_ready()
+{
+  return (true);
+}
+
+int
+EEPROM::Device::read(void* dest, const void* src, size_t size)
+{
+  size_t addr = (size_t) (uintptr_t) src;
+  if (addr >= MEM_MAX || size > MEM_MAX - addr) return (-1);
+  memcpy(dest, m_mem + addr, size);
+  return (size);
+}
+
+int
+EEPROM::Device::write(void* dest, const void* src, size_t size)
+{
+  size_t addr = (size_t) (uintptr_t) dest;
+  if (addr >= MEM_MAX || size > MEM_MAX - addr) return (-1);
+  memcpy(m_mem + addr, src, size);
+  if (m_fd >= 0 && pwrite(m_fd, m_mem + addr, size, addr) != (ssize_t) size)
+    return (-1);
+  return (size);
+}
@@ -0,0 +1,114 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_EEPROM_HH__
+#define __COSA_EEPROM_HH__
+
+#include "Cosa/Types.h"
+#include "Cosa/Power.hh"
+
+/**
+ * Linux host port of the Cosa EEPROM access class. The default
+ * device is a RAM image the size of the ATmega328P EEPROM (erased
+ * to 0xff). Binding it to a file with Device::begin() loads the
+ * image and writes every change through, so persistent state (e.g.
+ * RouteCachePersistent) survives a process restart. EEPROM
+ * addresses are offsets into the image, as on the target.
+ */
+class EEPROM {
+public:
+  class Device {
+  public:
+    /** Size of the emulated EEPROM in bytes */
+    static const size_t MEM_MAX = 1024;
+
+  protected:
+    uint8_t m_mem[MEM_MAX];
+    int m_fd;
+
+  public:
+    Device();
+    virtual ~Device();
+
+    /**
+     * Bind the image to the given file. An existing file is loaded,
+     * otherwise it is created from the current image.
+     * @param[in] path file name.
+     * @return true(1) if successful otherwise false(0)
+     */
+    bool begin(const char* path);
+
+    /**
+     * Release the file binding. The RAM image is kept.
+     * @return true(1) if successful otherwise false(0)
+     */
+    bool end();
+
+    virtual bool is_ready();
+    virtual int read(void* dest, const void* src, size_t size);
+    virtual int write(void* dest, const void* src, size_t size);
+
+    /** Default EEPROM device */
+    static Device eeprom;
+  };
+
+private:
+  Device* m_dev;
+
+public:
+  EEPROM(Device* dev = &Device::eeprom) : m_dev(dev) {}
+
+  bool is_ready()
+  {
+    return (m_dev->is_ready());
+  }
+
+  void write_await(uint8_t mode = SLEEP_MODE_IDLE)
+  {
+    while (!is_ready()) Power::sleep(mode);
+  }
+
+  int read(void* dest, const void* src, size_t size)
+  {
+    return (m_dev->read(dest, src, size));
+  }
+
+  template<class T> bool read(T* dest, const T* src)
+  {
+    return (m_dev->read(dest, src, sizeof(T)) == sizeof(T));
+  }
+
+  int write(void* dest, const void* src, size_t size)
+  {
+    return (m_dev->write(dest, src, size));
+  }
+
+  template<class T> int write(T* dest, const T* src)
+  {
+    return (m_dev->write(dest, src, sizeof(T)) == sizeof(T));
+  }
+
+  template<class T> int write(T* dest, T src)
+  {
+    return (m_dev->write(dest, &src, sizeof(T)));
+  }
+};
+
+#endif
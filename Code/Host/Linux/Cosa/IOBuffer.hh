@@ -0,0 +1,133 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_IOBUFFER_HH__
+#define __COSA_IOBUFFER_HH__
+
+#include "Cosa/Types.h"
+#include "Cosa/IOStream.hh"
+#include "Cosa/Power.hh"
+
+/**
+ * Circular buffer for IOStreams. Same implementation as on the
+ * target. SIZE must be a power of 2 and max 128.
+ */
+template <uint8_t SIZE>
+class IOBuffer : public IOStream::Device {
+private:
+  static const uint8_t MASK = (SIZE - 1);
+  volatile uint8_t m_head;
+  volatile uint8_t m_tail;
+  char m_buffer[SIZE];
+
+public:
+  IOBuffer() :
+    IOStream::Device(SLEEP_MODE_IDLE),
+    m_head(0),
+    m_tail(0)
+  {
+  }
+
+  bool is_empty()
+  {
+    return (m_head == m_tail);
+  }
+
+  bool is_full()
+  {
+    return (((m_head + 1) & MASK) == m_tail);
+  }
+
+  virtual int available()
+  {
+    return (SIZE + m_head - m_tail) & MASK;
+  }
+
+  virtual int room()
+  {
+    return (SIZE - m_head + m_tail - 1) & MASK;
+  }
+
+  virtual int putchar(char c);
+  virtual int peekchar();
+  virtual int peekchar(char c);
+  virtual int getchar();
+  virtual int flush();
+
+  void empty()
+  {
+    m_head = m_tail = 0;
+  }
+};
+
+template <uint8_t SIZE>
+int
+IOBuffer<SIZE>::putchar(char c)
+{
+  uint8_t next = (m_head + 1) & MASK;
+  if (next == m_tail) return (IOStream::EOF);
+  m_buffer[next] = c;
+  m_head = next;
+  return (c & 0xff);
+}
+
+template <uint8_t SIZE>
+int
+IOBuffer<SIZE>::peekchar()
+{
+  if (m_head == m_tail) return (IOStream::EOF);
+  uint8_t next = (m_tail + 1) & MASK;
+  return (m_buffer[next] & 0xff);
+}
+
+template <uint8_t SIZE>
+int
+IOBuffer<SIZE>::peekchar(char c)
+{
+  uint8_t tail = m_tail;
+  int res = 0;
+  while (tail != m_head) {
+    res += 1;
+    tail = (tail + 1) & MASK;
+    if (m_buffer[tail] == c) return (res);
+  }
+  return (IOStream::EOF);
+}
+
+template <uint8_t SIZE>
+int
+IOBuffer<SIZE>::getchar()
+{
+  if (m_head == m_tail) return (IOStream::EOF);
+  uint8_t next = (m_tail + 1) & MASK;
+  m_tail = next;
+  return (m_buffer[next] & 0xff);
+}
+
+template <uint8_t SIZE>
+int
+IOBuffer<SIZE>::flush()
+{
+  if (m_mode == NON_BLOCKING) return (IOStream::EOF);
+  while (m_head != m_tail) Power::sleep(m_mode);
+  return (0);
+}
+
+#endif
@@ -0,0 +1,396 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/IOStream.hh"
+#include "Cosa/Power.hh"
+#include <ctype.h>
+
+IOStream::Filter::Filter(Device* dev) :
+  m_dev(dev != NULL ? dev : &Device::null)
+{}
+
+IOStream::Filter::Filter() :
+  m_dev(&Device::null)
+{}
+
+IOStream::IOStream(Device* dev) :
+  m_dev(dev != NULL ? dev : &Device::null),
+  m_base(dec)
+{}
+
+IOStream::IOStream() :
+  m_dev(&Device::null),
+  m_base(dec)
+{}
+
+IOStream::Device*
+IOStream::set_device(Device* dev)
+{
+  Device* previous = m_dev;
+  if (dev == NULL) dev = &Device::null;
+  m_dev = dev;
+  return (previous);
+}
+
+void
+IOStream::print_digits(unsigned long int n, Base base)
+{
+  char buf[sizeof(long int) * CHARBITS + 1];
+  char* p = &buf[sizeof(buf) - 1];
+  *p = 0;
+  do {
+    uint8_t digit = n % base;
+    *--p = (digit < 10 ? '0' + digit : 'a' + digit - 10);
+    n /= base;
+  } while (n != 0);
+  print(p);
+}
+
+void
+IOStream::print(int n, Base base)
+{
+  if (base != bcd) {
+    if (base != dec) {
+      print_prefix(base);
+      print_digits((unsigned int) n, base);
+    }
+    else if (n < 0) {
+      print('-');
+      print_digits(-(long int) n, base);
+    }
+    else print_digits(n, base);
+  }
+  else {
+    print((char) ('0' + ((n >> 4) & 0xf)));
+    print((char) ('0' + (n & 0xf)));
+  }
+}
+
+void
+IOStream::print(long int n, Base base)
+{
+  if (base != dec) {
+    print_prefix(base);
+    print_digits((unsigned long int) n, base);
+  }
+  else if (n < 0) {
+    print('-');
+    print_digits(-(unsigned long int) n, base);
+  }
+  else print_digits(n, base);
+}
+
+void
+IOStream::print(unsigned int n, Base base)
+{
+  if (base != dec) print_prefix(base);
+  print_digits(n, base);
+}
+
+void
+IOStream::print(unsigned long int n, Base base)
+{
+  if (base != dec) print_prefix(base);
+  print_digits(n, base);
+}
+
+void
+IOStream::print(IOStream::Device* buffer)
+{
+  int c;
+  while ((c = buffer->getchar()) != EOF)
+    print((char) c);
+}
+
+void
+IOStream::print_prefix(Base base)
+{
+  if (base == hex)
+    print_P(PSTR("0x"));
+  else if (base == bin)
+    print_P(PSTR("0b"));
+  else if (base == oct)
+    print_P(PSTR("0"));
+}
+
+void
+IOStream::print(const void *ptr, size_t size, Base base, uint8_t max)
+{
+  uint8_t* p = (uint8_t*) ptr;
+  uint8_t n = 0;
+  print(p);
+  print_P(PSTR(": "));
+  while (size--) {
+    uint8_t v = *p++;
+    /* Fixed width per byte, as the target prints it */
+    if (base == hex) {
+      if (v < 0x10) print('0');
+    }
+    else if (base == oct) {
+      if (v < 010) print('0');
+      if (v < 0100) print('0');
+    }
+    else if (base == bin) {
+      for (uint8_t mask = 0x80; mask > 1 && (v & mask) == 0; mask >>= 1)
+	print('0');
+    }
+    print_digits(v, (base == bcd ? hex : base));
+    if (++n < max) {
+      print_P(PSTR(" "));
+    }
+    else {
+      println();
+      n = 0;
+      if (size > 0) {
+	print(p);
+	print_P(PSTR(": "));
+      }
+    }
+  }
+  if (n != 0) println();
+}
+
+void
+IOStream::vprintf_P(const char* format, va_list args)
+{
+  const char* s = format;
+  uint8_t is_signed;
+  Base base;
+  char c;
+  while ((c = pgm_read_byte(s++)) != 0) {
+    if (c == '%') {
+      is_signed = 1;
+      base = dec;
+    next:
+      c = pgm_read_byte(s++);
+      if (c == 0) s--;
+      switch (c) {
+      case 'b':
+	base = bin;
+	goto next;
+      case 'B':
+	base = bcd;
+	goto next;
+      case 'o':
+	base = oct;
+	goto next;
+      case 'h':
+      case 'x':
+	base = hex;
+	goto next;
+      case 'u':
+	is_signed = 0;
+	goto next;
+      case 'c':
+	print((char) va_arg(args, int));
+	continue;
+      case 'p':
+	print(va_arg(args, void*));
+	continue;
+      case 's':
+	print(va_arg(args, char*));
+	continue;
+      case 'S':
+	print_P(va_arg(args, const char*));
+	continue;
+      case 'd':
+	if (is_signed)
+	  print(va_arg(args, int), base);
+	else
+	  print(va_arg(args, unsigned int), base);
+	continue;
+      case 'l':
+	/* long is 32-bit on the target */
+	if (is_signed)
+	  print((long int) (int32_t) va_arg(args, int), base);
+	else
+	  print((unsigned long int) (uint32_t) va_arg(args, unsigned int), base);
+	continue;
+      };
+    }
+    print(c);
+  }
+}
+
+char*
+IOStream::scan(char *s, size_t count)
+{
+  if (m_dev == NULL) return (NULL);
+  char* res = s;
+  int c = m_dev->peekchar();
+  while (c <= ' ' && c != '\n') {
+    if (c == EOF) return (NULL);
+    c = m_dev->getchar();
+    c = m_dev->peekchar();
+  }
+  c = m_dev->getchar();
+  *s++ = c;
+  count -= 1;
+  if (isalpha(c)) {
+    while (count--) {
+      c = m_dev->peekchar();
+      if (!isalnum(c)) break;
+      c = m_dev->getchar();
+      *s++ = c;
+    }
+  }
+  else if (isdigit(c) || c == '-') {
+    while (count--) {
+      c = m_dev->peekchar();
+      if (!isdigit(c)) break;
+      c = m_dev->getchar();
+      *s++ = c;
+    }
+  }
+  *s = 0;
+  return (res);
+}
+
+IOStream::Device IOStream::Device::null;
+
+int
+IOStream::Device::available()
+{
+  return (0);
+}
+
+int
+IOStream::Device::room()
+{
+  return (0);
+}
+
+int
+IOStream::Device::putchar(char c)
+{
+  UNUSED(c);
+  return (EOF);
+}
+
+int
+IOStream::Device::puts(const char* s)
+{
+  return (write((const void*) s, strlen(s)));
+}
+
+int
+IOStream::Device::puts_P(const char* s)
+{
+  char c;
+  int n = 0;
+  while ((c = pgm_read_byte(s++)) != 0)
+    if (putchar(c) < 0)
+      break;
+    else
+      n += 1;
+  return (n);
+}
+
+int
+IOStream::Device::write(const void* buf, size_t size)
+{
+  const char* ptr = (const char*) buf;
+  size_t n = 0;
+  for(; n < size; n++)
+    if (putchar(*ptr++) < 0)
+      break;
+  return (n);
+}
+
+int
+IOStream::Device::write(const iovec_t* vec)
+{
+  size_t size = 0;
+  for (const iovec_t* vp = vec; vp->buf != NULL; vp++) {
+    size_t res = (size_t) write(vp->buf, vp->size);
+    if (res == 0) break;
+    size += res;
+  }
+  return (size);
+}
+
+int
+IOStream::Device::peekchar()
+{
+  return (EOF);
+}
+
+int
+IOStream::Device::peekchar(char c)
+{
+  UNUSED(c);
+  return (EOF);
+}
+
+int
+IOStream::Device::getchar()
+{
+  return (EOF);
+}
+
+char*
+IOStream::Device::gets(char *s, size_t count)
+{
+  char* res = s;
+  while (count--) {
+    int c = getchar();
+    if (c == EOF && m_mode != NON_BLOCKING) {
+      while (c == EOF) {
+	Power::sleep(m_mode);
+	c = getchar();
+      }
+    }
+    *s++ = c;
+    if (c == '\n' || c == IOStream::EOF) break;
+  }
+  *s = 0;
+  return (s == res ? NULL : res);
+}
+
+int
+IOStream::Device::read(void* buf, size_t size)
+{
+  char* ptr = (char*) buf;
+  size_t n = 0;
+  for (; n < size; n++) {
+    int c = getchar();
+    if (c < 0) break;
+    *ptr++ = c;
+  }
+  return (n);
+}
+
+int
+IOStream::Device::read(iovec_t* vec)
+{
+  size_t size = 0;
+  for (const iovec_t* vp = vec; vp->buf != NULL; vp++) {
+    size_t res = (size_t) read(vp->buf, vp->size);
+    if (res == 0) break;
+    size += res;
+  }
+  return (size);
+}
+
+int
+IOStream::Device::flush()
+{
+  return (EOF);
+}
@@ -0,0 +1,389 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_IOSTREAM_HH__
+#define __COSA_IOSTREAM_HH__
+
+#include "Cosa/Types.h"
+
+/**
+ * Linux host port of the Cosa IOStream. Same interface and output
+ * format as the target so that traces captured on the host and on
+ * the device can be compared line by line. The only difference is
+ * that pointers are printed with their full host width and that the
+ * "%l" format consumes a 32-bit argument, as on the AVR.
+ */
+class IOStream {
+public:
+  static const int EOF = -1;
+
+  /**
+   * Device for in/output of characters or strings.
+   */
+  class Device {
+  protected:
+    static const uint8_t NON_BLOCKING = 255;
+    uint8_t m_mode;
+
+  public:
+    Device(uint8_t mode = SLEEP_MODE_IDLE) : m_mode(mode) {}
+    virtual ~Device() {}
+
+    void set_non_blocking()
+    {
+      m_mode = NON_BLOCKING;
+    }
+
+    void set_blocking(uint8_t mode)
+    {
+      m_mode = mode;
+    }
+
+    virtual int available();
+    virtual int room();
+    virtual int putchar(char c);
+    virtual int puts(const char* s);
+    virtual int puts_P(const char* s);
+    virtual int write(const void* buf, size_t size);
+    virtual int write(const iovec_t* vec);
+    virtual int peekchar();
+    virtual int peekchar(char c);
+    virtual int getchar();
+    virtual char* gets(char *s, size_t count);
+    virtual int read(void* buf, size_t size);
+    virtual int read(iovec_t* vec);
+    virtual int flush();
+
+    /** Null device; default for IOStream and Trace. */
+    static Device null;
+  };
+
+  /**
+   * Filter for device (decorator). Default implementation passes
+   * all calls to the given device.
+   */
+  class Filter : public Device {
+  protected:
+    Device* m_dev;
+
+  public:
+    Filter(Device* dev);
+    Filter();
+
+    virtual int available()
+    {
+      return (m_dev->available());
+    }
+
+    virtual int room()
+    {
+      return (m_dev->room());
+    }
+
+    virtual int putchar(char c)
+    {
+      return (m_dev->putchar(c));
+    }
+
+    virtual int puts(const char* s)
+    {
+      return (m_dev->puts(s));
+    }
+
+    virtual int puts_P(const char* s)
+    {
+      return (m_dev->puts_P(s));
+    }
+
+    virtual int write(const void* buf, size_t size)
+    {
+      return (m_dev->write(buf, size));
+    }
+
+    virtual int write(const iovec_t* vec)
+    {
+      return (m_dev->write(vec));
+    }
+
+    virtual int peekchar()
+    {
+      return (m_dev->peekchar());
+    }
+
+    virtual int getchar()
+    {
+      return (m_dev->getchar());
+    }
+
+    virtual char* gets(char *s, size_t count)
+    {
+      return (m_dev->gets(s, count));
+    }
+
+    virtual int read(void* buf, size_t size)
+    {
+      return (m_dev->read(buf, size));
+    }
+
+    virtual int read(iovec_t* vec)
+    {
+      return (m_dev->read(vec));
+    }
+
+    virtual int flush()
+    {
+      return (m_dev->flush());
+    }
+  };
+
+  /**
+   * Base conversion.
+   */
+  enum Base {
+    bcd = 0,
+    bin = 2,
+    oct = 8,
+    dec = 10,
+    hex = 16
+  } __attribute__((packed));
+
+  IOStream(Device* dev);
+  IOStream();
+
+  Device* get_device()
+  {
+    return (m_dev);
+  }
+
+  Device* set_device(Device* dev);
+
+  void print(int value, Base base = dec);
+  void print(long int value, Base base = dec);
+  void print(unsigned int value, Base base = dec);
+  void print(unsigned long int value, Base base = dec);
+  void print(const void *ptr, size_t size, Base base = dec, uint8_t max = 16);
+
+  void print(void *ptr)
+  {
+    print((unsigned long int) (uintptr_t) ptr, hex);
+  }
+
+  void print(const void *ptr)
+  {
+    print((unsigned long int) (uintptr_t) ptr, hex);
+  }
+
+  void print(char c)
+  {
+    m_dev->putchar(c);
+  }
+
+  void print(const char* s)
+  {
+    m_dev->puts(s);
+  }
+
+  void print_P(const char* s)
+  {
+    m_dev->puts_P(s);
+  }
+
+  void println()
+  {
+    m_dev->putchar('\n');
+  }
+
+  /**
+   * Formatted print with variable argument list. Supports the Cosa
+   * format specifiers: %b %B %o %h %x %u %c %p %s %S %d %l.
+   * @param[in] format string.
+   * @param[in] args variable argument list.
+   */
+  void vprintf_P(const char* format, va_list args);
+
+  void printf_P(const char* format, ...)
+  {
+    va_list args;
+    va_start(args, format);
+    vprintf_P(format, args);
+    va_end(args);
+  }
+
+  void print(IOStream::Device* buffer);
+
+  char* scan(char *s, size_t count);
+
+  typedef IOStream& (*Manipulator)(IOStream&);
+
+  IOStream& operator<<(Manipulator func)
+  {
+    return (func(*this));
+  }
+
+  IOStream& operator<<(int n)
+  {
+    print(n, m_base);
+    m_base = dec;
+    return (*this);
+  }
+
+  IOStream& operator<<(long int n)
+  {
+    print(n, m_base);
+    m_base = dec;
+    return (*this);
+  }
+
+  IOStream& operator<<(unsigned int n)
+  {
+    print(n, m_base);
+    m_base = dec;
+    return (*this);
+  }
+
+  IOStream& operator<<(unsigned long int n)
+  {
+    print(n, m_base);
+    m_base = dec;
+    return (*this);
+  }
+
+  IOStream& operator<<(void* ptr)
+  {
+    print(ptr);
+    return (*this);
+  }
+
+  IOStream& operator<<(const void* ptr)
+  {
+    print(ptr);
+    return (*this);
+  }
+
+  IOStream& operator<<(char c)
+  {
+    print(c);
+    return (*this);
+  }
+
+  IOStream& operator<<(char* s)
+  {
+    print(s);
+    return (*this);
+  }
+
+  IOStream& operator<<(const char* s)
+  {
+    print_P(s);
+    return (*this);
+  }
+
+  IOStream& operator<<(IOStream& buffer)
+  {
+    print(buffer.m_dev);
+    return (*this);
+  }
+
+  friend IOStream& bcd(IOStream& outs);
+  friend IOStream& bin(IOStream& outs);
+  friend IOStream& oct(IOStream& outs);
+  friend IOStream& dec(IOStream& outs);
+  friend IOStream& hex(IOStream& outs);
+  friend IOStream& flush(IOStream& outs);
+
+private:
+  Device* m_dev;		/**< IOStream Device */
+  Base m_base;			/**< Base for next output operator */
+
+  void print_prefix(Base base);
+  void print_digits(unsigned long int n, Base base);
+};
+
+inline IOStream&
+bcd(IOStream& outs)
+{
+  outs.m_base = IOStream::bcd;
+  return (outs);
+}
+
+inline IOStream&
+bin(IOStream& outs)
+{
+  outs.m_base = IOStream::bin;
+  return (outs);
+}
+
+inline IOStream&
+oct(IOStream& outs)
+{
+  outs.m_base = IOStream::oct;
+  return (outs);
+}
+
+inline IOStream&
+dec(IOStream& outs)
+{
+  outs.m_base = IOStream::dec;
+  return (outs);
+}
+
+inline IOStream&
+hex(IOStream& outs)
+{
+  outs.m_base = IOStream::hex;
+  return (outs);
+}
+
+inline IOStream&
+tab(IOStream& outs)
+{
+  outs.print('\t');
+  return (outs);
+}
+
+inline IOStream&
+endl(IOStream& outs)
+{
+  outs.print('\n');
+  return (outs);
+}
+
+inline IOStream&
+ends(IOStream& outs)
+{
+  outs.print('\0');
+  return (outs);
+}
+
+inline IOStream&
+clear(IOStream& outs)
+{
+  outs.print('\f');
+  return (outs);
+}
+
+inline IOStream&
+flush(IOStream& outs)
+{
+  outs.m_dev->flush();
+  return (outs);
+}
+
+#endif
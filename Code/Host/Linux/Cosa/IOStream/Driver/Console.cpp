@@ -0,0 +1,77 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/IOStream/Driver/Console.hh"
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+Console console;
+
+int
+Console::available()
+{
+  struct pollfd pfd;
+  pfd.fd = STDIN_FILENO;
+  pfd.events = POLLIN;
+  return (::poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) ? 1 : 0);
+}
+
+int
+Console::room()
+{
+  return (BUFSIZ);
+}
+
+int
+Console::putchar(char c)
+{
+  return (fputc(c, stdout) < 0 ? IOStream::EOF : (c & 0xff));
+}
+
+int
+Console::write(const void* buf, size_t size)
+{
+  return (fwrite(buf, 1, size, stdout));
+}
+
+int
+Console::peekchar()
+{
+  if (!available()) return (IOStream::EOF);
+  int c = fgetc(stdin);
+  if (c < 0) return (IOStream::EOF);
+  ungetc(c, stdin);
+  return (c & 0xff);
+}
+
+int
+Console::getchar()
+{
+  if (!available()) return (IOStream::EOF);
+  int c = fgetc(stdin);
+  return (c < 0 ? IOStream::EOF : (c & 0xff));
+}
+
+int
+Console::flush()
+{
+  return (fflush(stdout) == 0 ? 0 : IOStream::EOF);
+}
@@ -0,0 +1,52 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_IOSTREAM_DRIVER_CONSOLE_HH__
+#define __COSA_IOSTREAM_DRIVER_CONSOLE_HH__
+
+#include "Cosa/Types.h"
+#include "Cosa/IOStream.hh"
+
+/**
+ * Host only IOStream device over the process standard output and
+ * input. Intended as trace device for host programs:
+ *   trace.begin(&console, PSTR("Banner"));
+ * Input is non-blocking; getchar() returns EOF when no data is
+ * pending on stdin.
+ */
+class Console : public IOStream::Device {
+public:
+  Console() : IOStream::Device() {}
+
+  virtual int available();
+  virtual int room();
+  virtual int putchar(char c);
+  virtual int write(const void* buf, size_t size);
+  virtual int peekchar();
+  virtual int getchar();
+  virtual int flush();
+};
+
+/**
+ * Standard in/output console.
+ */
+extern Console console;
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/IOStream/Driver/UART.hh"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+
+UART* UART::uart[4] = { NULL, NULL, NULL, NULL };
+
+static IOBuffer<UART::BUFFER_MAX> ibuf;
+static IOBuffer<UART::BUFFER_MAX> obuf;
+UART uart(0, &ibuf, &obuf);
+
+UART::UART(uint8_t port, IOStream::Device* ibuf, IOStream::Device* obuf) :
+  IOStream::Device(),
+  m_port(port),
+  m_ibuf(ibuf),
+  m_obuf(obuf),
+  m_fd(-1),
+  m_slave(-1)
+{
+  if (port < membersof(uart)) uart[port] = this;
+}
+
+UART::~UART()
+{
+  end();
+}
+
+bool
+UART::begin(uint32_t baudrate, uint8_t format)
+{
+  UNUSED(baudrate);
+  UNUSED(format);
+  if (m_fd >= 0) return (true);
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0) return (false);
+  if (grantpt(fd) != 0 || unlockpt(fd) != 0) goto error;
+  // Keep a slave descriptor open so the master does not see a hangup
+  // between clients, and put the line in raw mode for binary frames
+  m_slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+  if (m_slave < 0) goto error;
+  struct termios tio;
+  if (tcgetattr(m_slave, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(m_slave, TCSANOW, &tio);
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  m_fd = fd;
+  return (true);
+
+ error:
+  close(fd);
+  return (false);
+}
+
+bool
+UART::end()
+{
+  if (m_slave >= 0) close(m_slave);
+  if (m_fd >= 0) close(m_fd);
+  m_slave = -1;
+  m_fd = -1;
+  return (true);
+}
+
+const char*
+UART::get_device_name()
+{
+  if (m_fd < 0) return (NULL);
+  return (ptsname(m_fd));
+}
+
+bool
+UART::link(const char* path)
+{
+  const char* name = get_device_name();
+  if (name == NULL) return (false);
+  unlink(path);
+  return (symlink(name, path) == 0);
+}
+
+void
+UART::poll()
+{
+  if (m_fd < 0) return;
+  int room = m_ibuf->room();
+  while (room > 0) {
+    char buf[BUFFER_MAX];
+    ssize_t n = ::read(m_fd, buf, room < (int) sizeof(buf) ? room : sizeof(buf));
+    if (n <= 0) break;
+    for (ssize_t i = 0; i < n; i++)
+      m_ibuf->putchar(buf[i]);
+    room -= n;
+  }
+}
+
+int
+UART::putchar(char c)
+{
+  if (write(&c, 1) != 1) return (IOStream::EOF);
+  return (c & 0xff);
+}
+
+int
+UART::write(const void* buf, size_t size)
+{
+  if (m_fd < 0) return (-1);
+  const char* ptr = (const char*) buf;
+  size_t n = 0;
+  while (n < size) {
+    ssize_t res = ::write(m_fd, ptr + n, size - n);
+    if (res > 0) {
+      n += res;
+      continue;
+    }
+    if (res < 0 && errno == EINTR) continue;
+    // Terminal queue is full, i.e. nobody is reading the slave side.
+    // The target transmitter does not wait for a listener either, so
+    // the rest of the data is dropped
+    n = size;
+  }
+  if (n > 0) on_transmit_completed();
+  return (n);
+}
+
+int
+UART::flush()
+{
+  if (m_fd < 0) return (IOStream::EOF);
+  return (0);
+}
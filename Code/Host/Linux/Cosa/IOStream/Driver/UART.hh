@@ -0,0 +1,151 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_IOSTREAM_DRIVER_UART_HH__
+#define __COSA_IOSTREAM_DRIVER_UART_HH__
+
+#include "Cosa/Types.h"
+#include "Cosa/IOStream.hh"
+#include "Cosa/IOBuffer.hh"
+
+/**
+ * Linux host port of the Cosa UART. Each UART is backed by a pseudo
+ * terminal; begin() allocates the master side and the slave side
+ * (e.g. /dev/pts/3) can be opened by the host tools, such as the
+ * JMeshwork router, exactly like the USB serial port of a board.
+ * The baudrate and frame format are accepted but not applied.
+ *
+ * Received bytes are moved from the terminal to the input buffer
+ * whenever the input side is queried, so the non-blocking polling
+ * pattern used on the target (available() then getchar()) works
+ * unchanged. Output is written straight through.
+ */
+class UART : public IOStream::Device {
+protected:
+  uint8_t m_port;
+  IOStream::Device* m_ibuf;
+  IOStream::Device* m_obuf;
+  int m_fd;
+  int m_slave;
+
+  /**
+   * Move pending bytes from the terminal to the input buffer.
+   */
+  void poll();
+
+public:
+  static const uint8_t BUFFER_MAX = 64;
+
+  enum {
+    DATA5 = 0,
+    DATA6 = 2,
+    DATA7 = 4,
+    DATA8 = 6,
+    NO_PARITY = 0,
+    EVEN_PARITY = 32,
+    ODD_PARITY = 48,
+    STOP1 = 0,
+    STOP2 = 8
+  } __attribute__((packed));
+
+  /**
+   * Construct serial port handler for given UART.
+   * @param[in] port number.
+   * @param[in] ibuf input stream buffer.
+   * @param[in] obuf output stream buffer (room() only).
+   */
+  UART(uint8_t port, IOStream::Device* ibuf, IOStream::Device* obuf);
+  virtual ~UART();
+
+  virtual int available()
+  {
+    poll();
+    return (m_ibuf->available());
+  }
+
+  virtual int room()
+  {
+    return (m_obuf->room());
+  }
+
+  virtual int putchar(char c);
+  virtual int write(const void* buf, size_t size);
+
+  virtual int peekchar()
+  {
+    poll();
+    return (m_ibuf->peekchar());
+  }
+
+  virtual int peekchar(char c)
+  {
+    poll();
+    return (m_ibuf->peekchar(c));
+  }
+
+  virtual int getchar()
+  {
+    poll();
+    return (m_ibuf->getchar());
+  }
+
+  virtual int flush();
+
+  /**
+   * Open the pseudo terminal.
+   * @param[in] baudrate serial bitrate (ignored).
+   * @param[in] format serial frame format (ignored).
+   * @return true(1) if successful otherwise false(0)
+   */
+  bool begin(uint32_t baudrate = 9600, uint8_t format = DATA8 + STOP2 + NO_PARITY);
+
+  /**
+   * Close the pseudo terminal.
+   * @return true(1) if successful otherwise false(0)
+   */
+  bool end();
+
+  /**
+   * Return the slave device name of the pseudo terminal, or NULL
+   * if the port has not been started.
+   * @return device name.
+   */
+  const char* get_device_name();
+
+  /**
+   * Create a symbolic link with the given name to the slave device,
+   * so that host tools can be pointed to a fixed path.
+   * @param[in] path link name; an existing link is replaced.
+   * @return true(1) if successful otherwise false(0)
+   */
+  bool link(const char* path);
+
+  virtual void on_transmit_completed() {}
+
+  /** Ports by number */
+  static UART* uart[4];
+};
+
+/**
+ * Default serial port (port 0).
+ */
+extern UART uart;
+
+#endif
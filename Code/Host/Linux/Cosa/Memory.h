@@ -0,0 +1,39 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_MEMORY_H__
+#define __COSA_MEMORY_H__
+
+#include <malloc.h>
+#include <limits.h>
+
+/**
+ * Return amount of free memory. On the host this is the free space
+ * held by the heap allocator, clamped to the int range.
+ * @return number of bytes.
+ */
+inline int
+free_memory()
+{
+  struct mallinfo2 info = mallinfo2();
+  return (info.fordblks > (size_t) INT_MAX ? INT_MAX : (int) info.fordblks);
+}
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_PIN_HH__
+#define __COSA_PIN_HH__
+
+#include "Cosa/Types.h"
+
+/**
+ * Linux host pin abstraction. Pins are not backed by hardware; the
+ * level is kept in memory so that application code reading back
+ * its own outputs behaves as on the target.
+ */
+class Pin {
+protected:
+  uint8_t m_pin;
+  bool m_level;
+
+public:
+  Pin(uint8_t pin) :
+    m_pin(pin),
+    m_level(false)
+  {}
+
+  uint8_t get_pin() const
+  {
+    return (m_pin);
+  }
+
+  bool is_set() const
+  {
+    return (m_level);
+  }
+
+  bool is_high() const
+  {
+    return (m_level);
+  }
+
+  bool is_on() const
+  {
+    return (m_level);
+  }
+
+  bool is_clear() const
+  {
+    return (!m_level);
+  }
+
+  bool is_low() const
+  {
+    return (!m_level);
+  }
+
+  bool is_off() const
+  {
+    return (!m_level);
+  }
+
+  bool read() const
+  {
+    return (m_level);
+  }
+};
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/Power.hh"
+#include "Cosa/RTC.hh"
+
+uint8_t Power::s_mode = SLEEP_MODE_IDLE;
+
+void
+Power::sleep(uint8_t mode)
+{
+  UNUSED(mode);
+  RTC::Clock* clock = RTC::get_clock();
+  clock->sleep_until(clock->get_micros() + 1000);
+}
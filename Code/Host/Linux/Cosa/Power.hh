@@ -0,0 +1,66 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_POWER_HH__
+#define __COSA_POWER_HH__
+
+#include "Cosa/Types.h"
+
+/**
+ * Linux host port of the Cosa Power management. There are no
+ * peripherals to switch off; sleep() blocks for one milli-second on
+ * the RTC clock, standing in for "until the next interrupt".
+ */
+class Power {
+  Power() {}
+
+  static uint8_t s_mode;
+
+public:
+  static void set(uint8_t mode)
+  {
+    s_mode = mode;
+  }
+
+  /**
+   * Put the host to sleep for a short period.
+   * @param[in] mode sleep mode (ignored on the host).
+   */
+  static void sleep(uint8_t mode = 255);
+
+  static void adc_enable() {}
+  static void adc_disable() {}
+  static void timer0_enable() {}
+  static void timer0_disable() {}
+  static void timer1_enable() {}
+  static void timer1_disable() {}
+  static void timer2_enable() {}
+  static void timer2_disable() {}
+  static void spi_enable() {}
+  static void spi_disable() {}
+  static void twi_enable() {}
+  static void twi_disable() {}
+  static void usart0_enable() {}
+  static void usart0_disable() {}
+  static void all_enable() {}
+  static void all_disable() {}
+};
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/RTC.hh"
+#include <time.h>
+
+bool RTC::s_initiated = false;
+uint32_t RTC::s_sec = 0;
+RTC::InterruptHandler RTC::s_handler = NULL;
+void* RTC::s_env = NULL;
+
+/** Micro-seconds at the time of the last RTC::set(sec) */
+static uint64_t s_sec_base = 0;
+
+/**
+ * Default clock: CLOCK_MONOTONIC from the first query.
+ */
+class MonotonicClock : public RTC::Clock {
+private:
+  uint64_t m_epoch;
+
+  static uint64_t monotonic_us()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+  }
+
+public:
+  MonotonicClock() : m_epoch(0) {}
+
+  virtual uint64_t get_micros()
+  {
+    if (m_epoch == 0) m_epoch = monotonic_us();
+    return (monotonic_us() - m_epoch);
+  }
+
+  virtual void sleep_until(uint64_t us)
+  {
+    uint64_t now = get_micros();
+    if (us <= now) return;
+    struct timespec ts;
+    ts.tv_sec = (us - now) / 1000000ULL;
+    ts.tv_nsec = ((us - now) % 1000000ULL) * 1000;
+    while (nanosleep(&ts, &ts) != 0)
+      ;
+  }
+};
+
+static MonotonicClock s_monotonic;
+static RTC::Clock* s_clock = &s_monotonic;
+
+void
+RTC::set_clock(Clock* clock)
+{
+  s_clock = (clock != NULL ? clock : &s_monotonic);
+  s_sec_base = s_clock->get_micros();
+}
+
+RTC::Clock*
+RTC::get_clock()
+{
+  return (s_clock);
+}
+
+bool
+RTC::begin(InterruptHandler handler, void* env)
+{
+  if (s_initiated) return (false);
+  s_handler = handler;
+  s_env = env;
+  s_clock->get_micros();
+  s_initiated = true;
+  return (true);
+}
+
+bool
+RTC::end()
+{
+  s_initiated = false;
+  return (true);
+}
+
+void
+RTC::set(uint32_t sec)
+{
+  s_sec = sec;
+  s_sec_base = s_clock->get_micros();
+}
+
+uint32_t
+RTC::micros()
+{
+  return ((uint32_t) s_clock->get_micros());
+}
+
+uint32_t
+RTC::millis()
+{
+  return ((uint32_t) (s_clock->get_micros() / 1000ULL));
+}
+
+uint32_t
+RTC::seconds()
+{
+  return (s_sec + (uint32_t) ((s_clock->get_micros() - s_sec_base) / 1000000ULL));
+}
+
+void
+RTC::delay(uint16_t ms, uint8_t mode)
+{
+  UNUSED(mode);
+  s_clock->sleep_until(s_clock->get_micros() + ms * 1000ULL);
+}
@@ -0,0 +1,142 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_RTC_HH__
+#define __COSA_RTC_HH__
+
+#include "Cosa/Types.h"
+
+/**
+ * Linux host port of the Cosa real-time clock. Time is taken from a
+ * replaceable Clock; the default one reads CLOCK_MONOTONIC counted
+ * from the first call to begin() (or the first time query). All
+ * delays, including Watchdog and Power::sleep(), go through the same
+ * clock, so a simulation can substitute virtual time.
+ */
+class RTC {
+public:
+  typedef void (*InterruptHandler)(void* env);
+
+  /**
+   * Host only: source of time and blocking delays.
+   */
+  class Clock {
+  public:
+    virtual ~Clock() {}
+
+    /**
+     * Return micro-seconds since the clock epoch (64-bit, no wrap).
+     */
+    virtual uint64_t get_micros() = 0;
+
+    /**
+     * Block the calling thread until the given time.
+     * @param[in] us absolute time in micro-seconds.
+     */
+    virtual void sleep_until(uint64_t us) = 0;
+  };
+
+  /**
+   * Host only: install the clock; NULL restores the monotonic clock.
+   * @param[in] clock time source.
+   */
+  static void set_clock(Clock* clock);
+
+  /**
+   * Host only: return the installed clock.
+   */
+  static Clock* get_clock();
+
+private:
+  static bool s_initiated;
+  static uint32_t s_sec;
+  static InterruptHandler s_handler;
+  static void* s_env;
+
+  RTC() {}
+
+public:
+  /**
+   * Start the clock. The interrupt handler is kept for API
+   * compatibility only; there is no timer interrupt on the host.
+   * @param[in] handler of interrupts.
+   * @param[in] env handler environment.
+   * @return true(1) if successful otherwise false(0)
+   */
+  static bool begin(InterruptHandler handler = NULL, void* env = NULL);
+
+  /**
+   * Stop the clock.
+   * @return true(1) if successful otherwise false(0)
+   */
+  static bool end();
+
+  static uint16_t us_per_tick()
+  {
+    return (1);
+  }
+
+  static void set(InterruptHandler fn, void* env = NULL)
+  {
+    s_handler = fn;
+    s_env = env;
+  }
+
+  /**
+   * Set clock (seconds) to real-time (for instance seconds from a
+   * given date).
+   * @param[in] sec.
+   */
+  static void set(uint32_t sec);
+
+  static uint32_t diff(uint32_t x, uint32_t y)
+  {
+    return (x - y);
+  }
+
+  /**
+   * Return number of milli-seconds since given start.
+   * @param[in] start
+   * @return (RTC::millis() - start)
+   */
+  static uint32_t since(uint32_t start)
+  {
+    return (millis() - start);
+  }
+
+  static uint32_t micros();
+
+  /**
+   * Return milli-seconds. Derived from the 64-bit clock so that it
+   * wraps at 2^32 ms rather than with the micro-second counter.
+   */
+  static uint32_t millis();
+
+  static uint32_t seconds();
+
+  /**
+   * Delay using the real-time clock.
+   * @param[in] ms sleep period in milli-seconds.
+   * @param[in] mode during sleep (ignored on the host).
+   */
+  static void delay(uint16_t ms, uint8_t mode = SLEEP_MODE_IDLE);
+};
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_TYPES_H__
+#define __COSA_TYPES_H__
+
+/**
+ * Linux host replacement for Cosa/Types.h. Provides the subset of
+ * the Cosa basic types, program memory and interrupt lock macros
+ * used by the Meshwork library, mapped onto plain POSIX/libc.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The libc EOF macro would hide IOStream::EOF. Included once here,
+ * the stdio include guard keeps it from coming back; host code uses
+ * IOStream::EOF only.
+ */
+#undef EOF
+
+#include "Cosa/Board.hh"
+
+#define CHARBITS 8
+
+#ifndef NULL
+# define NULL ((void*) 0)
+#endif
+
+typedef float float32_t;
+
+#define LIKELY(x) __builtin_expect((x),1)
+#define UNLIKELY(x) __builtin_expect((x),0)
+#define UNUSED(x) (void) (x)
+#define membersof(x) (sizeof(x)/sizeof(x[0]))
+#define _BV(bit) (1 << (bit))
+
+/**
+ * There is no separate program memory on the host; strings and
+ * tables stay in data memory and the access macros become plain
+ * dereferences.
+ */
+#define PROGMEM
+#define __PROGMEM
+#undef PSTR
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*) (addr))
+#define pgm_read_word(addr) (*(const uint16_t*) (addr))
+#define pgm_read_dword(addr) (*(const uint32_t*) (addr))
+#define strlen_P(s) strlen(s)
+#define strcmp_P(s1, s2) strcmp(s1, s2)
+#define strcpy_P(dest, src) strcpy(dest, src)
+#define memcpy_P(dest, src, n) memcpy(dest, src, n)
+
+typedef const char* str_P;
+typedef const void* void_P;
+typedef const void_P void_vec_P;
+
+/**
+ * Sleep modes. Only used as tokens on the host, see Power::sleep().
+ */
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+#define SLEEP_MODE_PWR_DOWN 2
+#define SLEEP_MODE_PWR_SAVE 3
+#define SLEEP_MODE_STANDBY 6
+#define SLEEP_MODE_EXT_STANDBY 7
+
+#define MSLEEP(ms) Watchdog::delay(ms)
+#define SLEEP(seconds) Watchdog::delay(seconds * 1000)
+
+/**
+ * The host library is single threaded and there are no interrupt
+ * handlers, so the critical section is reduced to a single pass
+ * block. Keeps the Cosa syntax: synchronized { ... }
+ */
+#define synchronized							\
+  for (uint8_t __key = 1, i = 1; i != 0; i--, __key = 0)
+#define synchronized_return(expr)					\
+  return (UNUSED(__key), expr)
+#define synchronized_goto(label)					\
+  do { UNUSED(__key); goto label; } while (0)
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * Buffer structure for scatter/gather.
+ */
+struct iovec_t {
+  void* buf;			/**< Buffer pointer */
+  size_t size;			/**< Size of buffer in bytes */
+};
+
+/**
+ * Return total size of null terminated io buffer vector.
+ * @param[in] vec io vector pointer.
+ * @return size.
+ */
+inline size_t
+iovec_size(const iovec_t* vec)
+{
+  size_t len = 0;
+  for (const iovec_t* vp = vec; vp->buf != 0; vp++)
+    len += vp->size;
+  return (len);
+}
+
+/**
+ * Set next io-vector buffer. Used in the form:
+ * iovec_t vec[N]; iovec_t* vp = vec; iovec_arg(vp, buf, size);
+ * @param[in,out] vp io vector pointer.
+ * @param[in] buf buffer.
+ * @param[in] size number of bytes.
+ */
+inline void
+iovec_arg(iovec_t* &vp, const void* buf, size_t size)
+{
+  vp->buf = (void*) buf;
+  vp->size = size;
+  vp++;
+}
+
+/**
+ * Mark end of io-vector buffer at given index.
+ * @param[in,out] vp io vector pointer.
+ */
+inline void
+iovec_end(iovec_t* &vp)
+{
+  vp->buf = 0;
+  vp->size = 0;
+}
+
+template<class T>
+T map(T x, T in_min, T in_max, T out_min, T out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+#endif
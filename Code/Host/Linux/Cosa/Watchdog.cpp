@@ -0,0 +1,77 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#include "Cosa/Watchdog.hh"
+#include "Cosa/Power.hh"
+#include "Cosa/RTC.hh"
+
+Watchdog::InterruptHandler Watchdog::s_handler = NULL;
+void* Watchdog::s_env = NULL;
+uint32_t Watchdog::s_start = 0;
+uint16_t Watchdog::s_ms_per_tick = 16;
+uint8_t Watchdog::s_mode = SLEEP_MODE_IDLE;
+
+uint32_t
+Watchdog::ticks()
+{
+  return (RTC::since(s_start) / s_ms_per_tick);
+}
+
+void
+Watchdog::reset()
+{
+  s_start = RTC::millis();
+}
+
+void
+Watchdog::begin(uint16_t ms, uint8_t mode, InterruptHandler handler, void* env)
+{
+  uint16_t period = 16;
+  while (period < ms && period < 8192) period <<= 1;
+  s_ms_per_tick = period;
+  s_mode = mode;
+  s_handler = handler;
+  s_env = env;
+  reset();
+}
+
+void
+Watchdog::await(AwaitCondition fn, void* env, uint32_t ms)
+{
+  uint32_t start = RTC::millis();
+  do {
+    if (fn != NULL && fn(env)) return;
+    if (fn == NULL) {
+      uint32_t passed = RTC::since(start);
+      if (passed >= ms) return;
+      uint32_t left = ms - passed;
+      RTC::delay(left > UINT16_MAX ? UINT16_MAX : left);
+      continue;
+    }
+    Power::sleep(s_mode);
+  } while ((ms == 0) || (RTC::since(start) < ms));
+}
+
+void
+Watchdog::end()
+{
+  s_handler = NULL;
+  s_env = NULL;
+}
@@ -0,0 +1,112 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_WATCHDOG_HH__
+#define __COSA_WATCHDOG_HH__
+
+#include "Cosa/Types.h"
+
+/**
+ * Linux host port of the Cosa Watchdog. The tick counter is derived
+ * from the RTC clock (see RTC::Clock) and delays block the calling
+ * thread. Timeout event queues are not supported.
+ */
+class Watchdog {
+public:
+  typedef void (*InterruptHandler)(void* env);
+  typedef bool (*AwaitCondition)(void* env);
+
+private:
+  Watchdog() {}
+
+  static InterruptHandler s_handler;
+  static void* s_env;
+  static uint32_t s_start;
+  static uint16_t s_ms_per_tick;
+  static uint8_t s_mode;
+
+public:
+  /**
+   * Get number of watchdog cycles since begin() or reset().
+   * @return number of ticks.
+   */
+  static uint32_t ticks();
+
+  static uint32_t millis()
+  {
+    return (ticks() * ms_per_tick());
+  }
+
+  static void reset();
+
+  static uint16_t ms_per_tick()
+  {
+    return (s_ms_per_tick);
+  }
+
+  static void set(InterruptHandler fn, void* env = NULL)
+  {
+    s_handler = fn;
+    s_env = env;
+  }
+
+  static void set(uint8_t mode)
+  {
+    s_mode = mode;
+  }
+
+  /**
+   * Start watchdog with given period (milli-seconds). Rounded to the
+   * nearest power of two, 16..8192 ms, as on the target.
+   * @param[in] ms timeout period.
+   * @param[in] mode of sleep (ignored on the host).
+   * @param[in] handler of interrupts (not called on the host).
+   * @param[in] env handler environment.
+   */
+  static void begin(uint16_t ms = 16,
+		    uint8_t mode = SLEEP_MODE_IDLE,
+		    InterruptHandler handler = NULL,
+		    void* env = NULL);
+
+  /**
+   * Wait for the given condition function to return true or the
+   * period (milli-seconds) to pass. If no condition is given, wait
+   * for the period only.
+   * @param[in] fn condition function.
+   * @param[in] env condition function environment.
+   * @param[in] ms milli-seconds to wait.
+   */
+  static void await(AwaitCondition fn = NULL,
+		    void* env = NULL,
+		    uint32_t ms = 0);
+
+  /**
+   * Delay given number of milli-seconds.
+   * @param[in] ms milli-seconds delay.
+   */
+  static void delay(uint32_t ms)
+  {
+    await(NULL, NULL, ms);
+  }
+
+  static void end();
+};
+
+#endif
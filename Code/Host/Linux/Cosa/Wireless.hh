@@ -0,0 +1,216 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __COSA_WIRELESS_HH__
+#define __COSA_WIRELESS_HH__
+
+#include "Cosa/Types.h"
+#include "Cosa/Power.hh"
+
+/**
+ * Linux host copy of the Cosa Wireless interface. Identical driver
+ * contract to the target so that the network layers can run over
+ * host drivers (see the Simulation directory).
+ */
+class Wireless {
+public:
+  /**
+   * Common wireless device driver interface.
+   */
+  class Driver {
+  public:
+    /**
+     * Device address; network and device.
+     */
+    struct addr_t {
+      uint8_t device;		/**< device address (LSB) */
+      int16_t network;		/**< network address */
+      addr_t(int16_t net, uint8_t dev)
+      {
+	network = net;
+	device = dev;
+      }
+    };
+
+    /** Broadcast device address */
+    static const uint8_t BROADCAST = 0x00;
+
+    /**
+     * Driver capabilities; see get_capabilities().
+     */
+    struct capabilities_t {
+      uint8_t payload_max;	/**< max payload per message, 0 if unknown */
+      bool broadcast;		/**< BROADCAST destination supported */
+      bool rssi;		/**< get_input_power_level() is measured */
+      bool lqi;			/**< get_link_quality_indicator() is measured */
+      bool retransmits;		/**< get_retransmit_count() is measured */
+    };
+
+  protected:
+    uint8_t m_channel;
+    addr_t m_addr;
+    volatile bool m_avail;
+    uint8_t m_mode;
+    uint8_t m_dest;
+
+  public:
+    Driver(int16_t network, uint8_t device) :
+      m_channel(0),
+      m_addr(network, device),
+      m_avail(false),
+      m_mode(SLEEP_MODE_IDLE),
+      m_dest(0)
+    {}
+
+    virtual ~Driver() {}
+
+    uint8_t get_channel()
+    {
+      return (m_channel);
+    }
+
+    int16_t get_network_address()
+    {
+      return (m_addr.network);
+    }
+
+    uint8_t get_device_address()
+    {
+      return (m_addr.device);
+    }
+
+    void set_sleep(uint8_t mode)
+    {
+      m_mode = mode;
+    }
+
+    void set_address(int16_t net, uint8_t dev)
+    {
+      m_addr.network = net;
+      m_addr.device = dev;
+    }
+
+    void set_channel(uint8_t channel)
+    {
+      m_channel = channel;
+    }
+
+    virtual bool begin(const void* config = NULL) = 0;
+
+    virtual bool end()
+    {
+      return (true);
+    }
+
+    virtual void powerup() {}
+    virtual void powerdown() {}
+    virtual void wakeup_on_radio() {}
+
+    virtual bool available()
+    {
+      return (m_avail);
+    }
+
+    virtual bool room()
+    {
+      return (true);
+    }
+
+    /**
+     * Send message in given null terminated io vector.
+     * @param[in] dest destination network address.
+     * @param[in] port device port (or message type).
+     * @param[in] vec null termianted io vector.
+     * @return number of bytes send or negative error code.
+     */
+    virtual int send(uint8_t dest, uint8_t port, const iovec_t* vec) = 0;
+
+    virtual int send(uint8_t dest, uint8_t port, const void* buf, size_t len)
+    {
+      iovec_t vec[2];
+      iovec_t* vp = vec;
+      iovec_arg(vp, buf, len);
+      iovec_end(vp);
+      return (send(dest, port, vec));
+    }
+
+    virtual int broadcast(uint8_t port, const iovec_t* vec)
+    {
+      return (send(BROADCAST, port, vec));
+    }
+
+    virtual int broadcast(uint8_t port, const void* buf, size_t len)
+    {
+      return (send(BROADCAST, port, buf, len));
+    }
+
+    /**
+     * Receive message and store into given buffer with given maximum
+     * length. The source network address is returned in the parameter
+     * src.
+     * @param[out] src source network address.
+     * @param[out] port device port (or message type).
+     * @param[in] buf buffer to store incoming message.
+     * @param[in] len maximum number of bytes to receive.
+     * @param[in] ms maximum time out period.
+     * @return number of bytes received or negative error code
+     * (-1 message too large for buffer, -2 timeout).
+     */
+    virtual int recv(uint8_t& src, uint8_t& port,
+		     void* buf, size_t len,
+		     uint32_t ms = 0L) = 0;
+
+    virtual bool is_broadcast()
+    {
+      return (m_dest == BROADCAST);
+    }
+
+    virtual void set_output_power_level(int8_t dBm)
+    {
+      UNUSED(dBm);
+    }
+
+    virtual int get_input_power_level()
+    {
+      return (0);
+    }
+
+    virtual int get_link_quality_indicator()
+    {
+      return (0);
+    }
+
+    virtual int get_retransmit_count()
+    {
+      return (0);
+    }
+
+    virtual void get_capabilities(capabilities_t& caps)
+    {
+      caps.payload_max = 0;
+      caps.broadcast = true;
+      caps.rssi = false;
+      caps.lqi = false;
+      caps.retransmits = false;
+    }
+  };
+};
+
+#endif
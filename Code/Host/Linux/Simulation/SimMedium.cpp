@@ -0,0 +1,394 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMMEDIUM_CPP__
+#define __MESHWORK_SIMULATION_SIMMEDIUM_CPP__
+
+#include <errno.h>
+#include <time.h>
+
+#include "Simulation/SimMedium.h"
+#include "Simulation/SimRadioDriver.h"
+
+using Meshwork::Simulation::SimMedium;
+using Meshwork::Simulation::SimRadioDriver;
+
+const float SimMedium::LINK_NONE = -1.0f;
+
+//NRF24L01P enhanced shockburst frame overhead in bits:
+//preamble(8) + address(40) + packet control(9) + CRC(16)
+static const uint32_t FRAME_OVERHEAD_BITS = 8 + 40 + 9 + 16;
+//Cosa prepends the source address and port to every payload
+static const uint8_t FRAME_HEADER_BYTES = 2;
+
+static uint64_t monotonic_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void sleep_us(uint64_t us) {
+	struct timespec ts;
+	ts.tv_sec = us / 1000000ULL;
+	ts.tv_nsec = (us % 1000000ULL) * 1000;
+	while ( nanosleep(&ts, &ts) != 0 && errno == EINTR )
+		;
+}
+
+SimMedium::SimMedium(uint32_t seed):
+	m_latency(DEFAULT_LATENCY_US),
+	m_bitrate(DEFAULT_BITRATE),
+	m_arc(DEFAULT_ARC),
+	m_ard(DEFAULT_ARD_US),
+	m_scheduler(NULL)
+{
+	pthread_mutex_init(&m_lock, NULL);
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ ) {
+		node_t* node = &m_nodes[i];
+		node->driver = NULL;
+		node->head = node->count = 0;
+		pthread_cond_init(&node->cond, &attr);
+		memset(&node->stats, 0, sizeof(node->stats));
+	}
+	pthread_condattr_destroy(&attr);
+	disconnect_all();
+	set_seed(seed);
+}
+
+SimMedium::~SimMedium() {
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ )
+		pthread_cond_destroy(&m_nodes[i].cond);
+	pthread_mutex_destroy(&m_lock);
+}
+
+uint64_t SimMedium::now() {
+	return m_scheduler != NULL ? m_scheduler->get_micros() : monotonic_us();
+}
+
+void SimMedium::sleep_until(uint64_t us) {
+	if ( m_scheduler != NULL ) {
+		m_scheduler->sleep_until(us);
+	} else {
+		uint64_t t = monotonic_us();
+		if ( us > t )
+			sleep_us(us - t);
+	}
+}
+
+void SimMedium::wait(node_t* node, uint64_t deadline) {
+	if ( m_scheduler != NULL ) {
+		m_scheduler->wait(node, deadline, &m_lock);
+	} else if ( deadline == SimScheduler::NEVER ) {
+		pthread_cond_wait(&node->cond, &m_lock);
+	} else {
+		struct timespec ts;
+		ts.tv_sec = deadline / 1000000ULL;
+		ts.tv_nsec = (deadline % 1000000ULL) * 1000;
+		pthread_cond_timedwait(&node->cond, &m_lock, &ts);
+	}
+}
+
+void SimMedium::notify(node_t* node, uint64_t at) {
+	if ( m_scheduler != NULL )
+		m_scheduler->notify(node, at);
+	else
+		pthread_cond_broadcast(&node->cond);
+}
+
+void SimMedium::set_seed(uint32_t seed) {
+	m_random = seed == 0 ? 0x9E3779B9 : seed;
+}
+
+uint32_t SimMedium::random() {
+	uint32_t x = m_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return m_random = x;
+}
+
+bool SimMedium::lost(uint8_t src, uint8_t dst) {
+	float loss = m_loss[src][dst];
+	if ( loss <= 0.0f )
+		return false;
+	return (random() >> 8) < (uint32_t) (loss * (1UL << 24));
+}
+
+uint32_t SimMedium::airtime(uint8_t len) {
+	uint32_t bits = FRAME_OVERHEAD_BITS + len * 8;
+	return (uint32_t) (((uint64_t) bits * 1000000ULL + m_bitrate - 1) / m_bitrate);
+}
+
+void SimMedium::link(uint8_t src, uint8_t dst, float loss) {
+	if ( src == Wireless::Driver::BROADCAST || dst == Wireless::Driver::BROADCAST || src == dst )
+		return;
+	pthread_mutex_lock(&m_lock);
+	m_loss[src][dst] = loss < 0.0f ? 0.0f : (loss > 1.0f ? 1.0f : loss);
+	pthread_mutex_unlock(&m_lock);
+}
+
+void SimMedium::connect(uint8_t a, uint8_t b, float loss) {
+	link(a, b, loss);
+	link(b, a, loss);
+}
+
+void SimMedium::disconnect(uint8_t a, uint8_t b) {
+	pthread_mutex_lock(&m_lock);
+	m_loss[a][b] = m_loss[b][a] = LINK_NONE;
+	pthread_mutex_unlock(&m_lock);
+}
+
+void SimMedium::disconnect_all() {
+	pthread_mutex_lock(&m_lock);
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ )
+		for ( uint16_t j = 0; j < NODE_MAX; j ++ )
+			m_loss[i][j] = LINK_NONE;
+	pthread_mutex_unlock(&m_lock);
+}
+
+bool SimMedium::is_linked(uint8_t src, uint8_t dst) {
+	return m_loss[src][dst] != LINK_NONE;
+}
+
+float SimMedium::get_loss(uint8_t src, uint8_t dst) {
+	return m_loss[src][dst];
+}
+
+void SimMedium::connect_line(uint8_t first, uint8_t count, float loss) {
+	for ( uint16_t i = 1; i < count; i ++ )
+		connect(first + i - 1, first + i, loss);
+}
+
+void SimMedium::connect_grid(uint8_t first, uint8_t cols, uint8_t rows, float loss) {
+	for ( uint16_t r = 0; r < rows; r ++ )
+		for ( uint16_t c = 0; c < cols; c ++ ) {
+			uint8_t id = first + r * cols + c;
+			if ( c + 1 < cols )
+				connect(id, id + 1, loss);
+			if ( r + 1 < rows )
+				connect(id, id + cols, loss);
+		}
+}
+
+bool SimMedium::attach(SimRadioDriver* driver) {
+	uint8_t addr = driver->get_device_address();
+	if ( addr == Wireless::Driver::BROADCAST )
+		return false;
+	pthread_mutex_lock(&m_lock);
+	node_t* node = &m_nodes[addr];
+	bool result = node->driver == NULL || node->driver == driver;
+	if ( result ) {
+		node->driver = driver;
+		node->head = node->count = 0;
+	}
+	pthread_mutex_unlock(&m_lock);
+	return result;
+}
+
+void SimMedium::detach(SimRadioDriver* driver) {
+	pthread_mutex_lock(&m_lock);
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ )
+		if ( m_nodes[i].driver == driver ) {
+			m_nodes[i].driver = NULL;
+			m_nodes[i].count = 0;
+			notify(&m_nodes[i], 0);
+		}
+	pthread_mutex_unlock(&m_lock);
+}
+
+//must be called with m_lock held
+bool SimMedium::fifo_push(uint8_t dst, const frame_t* frame) {
+	node_t* node = &m_nodes[dst];
+	if ( node->count == RX_FIFO_MAX ) {
+		node->stats.rx_fifo_full ++;
+		return false;
+	}
+	node->fifo[(node->head + node->count) % RX_FIFO_MAX] = *frame;
+	node->count ++;
+	notify(node, frame->ready);
+	return true;
+}
+
+int SimMedium::transmit(SimRadioDriver* driver, uint8_t dest, uint8_t port, const iovec_t* vec,
+						uint8_t* retransmits) {
+	if ( retransmits != NULL )
+		*retransmits = 0;
+	if ( vec == NULL )
+		return -1;
+	frame_t frame;
+	size_t len = 0;
+	for ( const iovec_t* vp = vec; vp->buf != NULL; vp ++ ) {
+		if ( len + vp->size > FRAME_MAX )
+			return -1;
+		memcpy(frame.data + len, vp->buf, vp->size);
+		len += vp->size;
+	}
+	uint8_t src = driver->get_device_address();
+	frame.src = src;
+	frame.dest = dest;
+	frame.port = port;
+	frame.len = len;
+
+	pthread_mutex_lock(&m_lock);
+	uint64_t start = now();
+	node_t* sender = &m_nodes[src];
+	sender->stats.tx_frames ++;
+	sender->stats.tx_bytes += len;
+	uint32_t frameAir = airtime(FRAME_HEADER_BYTES + len);
+	uint32_t ackAir = airtime(0);
+	uint64_t done = start + m_latency;
+	int result = len;
+
+	if ( dest == Wireless::Driver::BROADCAST ) {
+		//single shot, no ACK; every neighbour on the same network hears it or not
+		sender->stats.tx_attempts ++;
+		sender->stats.airtime += frameAir;
+		frame.ready = done;
+		for ( uint16_t i = 1; i < NODE_MAX; i ++ ) {
+			SimRadioDriver* rcv = m_nodes[i].driver;
+			if ( rcv != NULL && i != src && is_linked(src, i) &&
+					rcv->get_network_address() == driver->get_network_address() &&
+					rcv->get_channel() == driver->get_channel() && !lost(src, i) )
+				fifo_push(i, &frame);
+		}
+	} else {
+		//auto-ACK with retransmissions; the chip drops duplicates by packet id,
+		//so the receiver stores the frame at most once
+		SimRadioDriver* rcv = m_nodes[dest].driver;
+		bool reachable = rcv != NULL && is_linked(src, dest) &&
+							rcv->get_network_address() == driver->get_network_address() &&
+							rcv->get_channel() == driver->get_channel();
+		bool stored = false;
+		bool acked = false;
+		for ( uint8_t attempt = 0; attempt <= m_arc && !acked; attempt ++ ) {
+			if ( attempt > 0 ) {
+				sender->stats.tx_retransmits ++;
+				done += m_ard;
+				if ( retransmits != NULL )
+					*retransmits = attempt;
+			}
+			sender->stats.tx_attempts ++;
+			sender->stats.airtime += frameAir;
+			if ( !reachable || lost(src, dest) )
+				continue;
+			if ( !stored ) {
+				frame.ready = done;
+				if ( !fifo_push(dest, &frame) )
+					continue;//no room, no ACK
+				stored = true;
+			}
+			sender->stats.airtime += ackAir;
+			acked = !lost(dest, src);
+		}
+		if ( !acked ) {
+			sender->stats.tx_failed ++;
+			result = -2;
+		}
+	}
+	pthread_mutex_unlock(&m_lock);
+
+	//the sender is busy until the transmission completes
+	sleep_until(done);
+	return result;
+}
+
+bool SimMedium::available(SimRadioDriver* driver) {
+	pthread_mutex_lock(&m_lock);
+	node_t* node = &m_nodes[driver->get_device_address()];
+	bool result = node->driver == driver && node->count > 0 &&
+					node->fifo[node->head].ready <= now();
+	pthread_mutex_unlock(&m_lock);
+	return result;
+}
+
+int SimMedium::receive(SimRadioDriver* driver, uint8_t& src, uint8_t& port, uint8_t& dest,
+						void* buf, size_t len, uint32_t ms) {
+	node_t* node = &m_nodes[driver->get_device_address()];
+	uint64_t deadline = ms == 0 ? SimScheduler::NEVER : now() + (uint64_t) ms * 1000;
+	int result = -2;
+
+	pthread_mutex_lock(&m_lock);
+	while ( node->driver == driver ) {
+		uint64_t t = now();
+		uint64_t wake = deadline;
+		if ( node->count > 0 ) {
+			frame_t* frame = &node->fifo[node->head];
+			if ( frame->ready <= t ) {
+				node->head = (node->head + 1) % RX_FIFO_MAX;
+				node->count --;
+				if ( frame->len > len ) {
+					node->stats.rx_overflow ++;
+					result = -1;
+				} else {
+					src = frame->src;
+					port = frame->port;
+					dest = frame->dest;
+					memcpy(buf, frame->data, frame->len);
+					node->stats.rx_frames ++;
+					result = frame->len;
+				}
+				break;
+			}
+			//frame still in flight
+			if ( frame->ready < wake )
+				wake = frame->ready;
+		}
+		if ( t >= deadline )
+			break;
+		wait(node, wake);
+	}
+	pthread_mutex_unlock(&m_lock);
+	return result;
+}
+
+void SimMedium::get_stats(uint8_t node, stats_t& stats) {
+	pthread_mutex_lock(&m_lock);
+	stats = m_nodes[node].stats;
+	pthread_mutex_unlock(&m_lock);
+}
+
+void SimMedium::get_stats_total(stats_t& stats) {
+	memset(&stats, 0, sizeof(stats));
+	pthread_mutex_lock(&m_lock);
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ ) {
+		stats_t* s = &m_nodes[i].stats;
+		stats.tx_frames += s->tx_frames;
+		stats.tx_bytes += s->tx_bytes;
+		stats.tx_attempts += s->tx_attempts;
+		stats.tx_retransmits += s->tx_retransmits;
+		stats.tx_failed += s->tx_failed;
+		stats.rx_frames += s->rx_frames;
+		stats.rx_overflow += s->rx_overflow;
+		stats.rx_fifo_full += s->rx_fifo_full;
+		stats.airtime += s->airtime;
+	}
+	pthread_mutex_unlock(&m_lock);
+}
+
+void SimMedium::reset_stats() {
+	pthread_mutex_lock(&m_lock);
+	for ( uint16_t i = 0; i < NODE_MAX; i ++ )
+		memset(&m_nodes[i].stats, 0, sizeof(m_nodes[i].stats));
+	pthread_mutex_unlock(&m_lock);
+}
+#endif
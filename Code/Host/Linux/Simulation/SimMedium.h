@@ -0,0 +1,217 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMMEDIUM_H__
+#define __MESHWORK_SIMULATION_SIMMEDIUM_H__
+
+#include <pthread.h>
+
+#include "Cosa/Types.h"
+#include "Cosa/Wireless.hh"
+#include "Simulation/SimScheduler.h"
+
+/**
+ * Shared radio medium for in-process simulations. Links any number
+ * of SimRadioDriver instances (one per simulated node, addressed by
+ * device address) through a directed adjacency graph. Each link has
+ * its own loss probability; every frame takes a configurable latency
+ * before it reaches the receiver.
+ *
+ * The delivery rules follow the NRF24L01P as driven by Cosa:
+ * - unicast frames use hardware auto-ACK with up to ARC
+ *   retransmissions; the data frame and the ACK can each be lost
+ * - broadcast frames are sent once without ACK and fanned out to all
+ *   neighbours, each neighbour losing it independently
+ * - a receiver holds up to RX_FIFO_MAX frames; a full FIFO does not
+ *   acknowledge, just like the chip
+ * Collisions and half-duplex effects are not modelled.
+ *
+ * The medium runs in real time by default. With a SimScheduler set,
+ * latencies, retransmission delays and receive timeouts elapse in
+ * virtual time instead.
+ */
+namespace Meshwork {
+
+	namespace Simulation {
+
+		class SimRadioDriver;
+
+		class SimMedium {
+		public:
+			/** Number of device addresses; 0 is broadcast. */
+			static const uint16_t NODE_MAX = 256;
+			/** Maximum frame payload; same as NRF24L01P::PAYLOAD_MAX. */
+			static const uint8_t FRAME_MAX = 30;
+			/** Receiver FIFO depth; same as the NRF24L01P. */
+			static const uint8_t RX_FIFO_MAX = 3;
+			/** Default auto retransmit count (Cosa NRF24L01P setup). */
+			static const uint8_t DEFAULT_ARC = 15;
+			/** Default auto retransmit delay, us (Cosa NRF24L01P setup). */
+			static const uint16_t DEFAULT_ARD_US = 750;
+			/** Default per-frame latency, us. */
+			static const uint32_t DEFAULT_LATENCY_US = 1000;
+			/** Default air bitrate, bit/s (2 Mbps). */
+			static const uint32_t DEFAULT_BITRATE = 2000000;
+
+			struct frame_t {
+				uint8_t src;
+				uint8_t dest;
+				uint8_t port;
+				uint8_t len;
+				uint8_t data[FRAME_MAX];
+				uint64_t ready;//us, frame visible to the receiver from this time on
+			};
+
+			struct stats_t {
+				uint32_t tx_frames;			//frames passed to send()
+				uint32_t tx_bytes;			//payload bytes passed to send()
+				uint32_t tx_attempts;		//over the air transmissions incl. retransmissions
+				uint32_t tx_retransmits;	//hardware retransmissions
+				uint32_t tx_failed;			//unicast frames not acknowledged (-2)
+				uint32_t rx_frames;			//frames returned by recv()
+				uint32_t rx_overflow;		//frames dropped by recv() for a short buffer (-1)
+				uint32_t rx_fifo_full;		//frames not accepted due to a full FIFO
+				uint64_t airtime;			//us, time on air incl. hardware ACKs
+			};
+
+		protected:
+			struct node_t {
+				SimRadioDriver* driver;
+				frame_t fifo[RX_FIFO_MAX];
+				uint8_t head;
+				uint8_t count;
+				pthread_cond_t cond;
+				stats_t stats;
+			};
+
+			static const float LINK_NONE;
+
+			pthread_mutex_t m_lock;
+			node_t m_nodes[NODE_MAX];
+			float m_loss[NODE_MAX][NODE_MAX];
+			uint32_t m_latency;
+			uint32_t m_bitrate;
+			uint8_t m_arc;
+			uint16_t m_ard;
+			uint32_t m_random;
+			SimScheduler* m_scheduler;
+
+			//current time, us; virtual if a scheduler is set
+			uint64_t now();
+			//block until the given time
+			void sleep_until(uint64_t us);
+			//block on the node until fifo_push()/detach() or the deadline; m_lock held
+			void wait(node_t* node, uint64_t deadline);
+			//wake up the node's receiver at the given time; m_lock held
+			void notify(node_t* node, uint64_t at);
+			//xorshift32; deterministic per seed
+			uint32_t random();
+			bool lost(uint8_t src, uint8_t dst);
+			//time on air for a packet with the given payload bytes, us
+			uint32_t airtime(uint8_t len);
+			bool fifo_push(uint8_t dst, const frame_t* frame);
+
+		public:
+			SimMedium(uint32_t seed = 1);
+			~SimMedium();
+
+			void set_seed(uint32_t seed);
+
+			/**
+			 * Run in virtual time on the given scheduler, or in real
+			 * time if NULL. Set before the drivers are used.
+			 */
+			void set_scheduler(SimScheduler* scheduler) {
+				m_scheduler = scheduler;
+			}
+
+			SimScheduler* get_scheduler() {
+				return m_scheduler;
+			}
+
+			/** Per-frame latency from start of transmission to the receiver, us. */
+			void set_latency(uint32_t us) {
+				m_latency = us;
+			}
+
+			uint32_t get_latency() {
+				return m_latency;
+			}
+
+			/** Air bitrate used for the airtime statistics, bit/s. */
+			void set_bitrate(uint32_t bitrate) {
+				m_bitrate = bitrate;
+			}
+
+			/** Hardware auto retransmission count and delay (us). */
+			void set_retransmit(uint8_t arc, uint16_t ard) {
+				m_arc = arc;
+				m_ard = ard;
+			}
+
+			///////////// Topology /////////////
+			/** Directed link src->dst with given loss probability [0..1]. */
+			void link(uint8_t src, uint8_t dst, float loss = 0.0f);
+			/** Bidirectional link with the same loss in both directions. */
+			void connect(uint8_t a, uint8_t b, float loss = 0.0f);
+			void disconnect(uint8_t a, uint8_t b);
+			void disconnect_all();
+			bool is_linked(uint8_t src, uint8_t dst);
+			float get_loss(uint8_t src, uint8_t dst);
+
+			/** Chain first, first+1, ..., first+count-1. */
+			void connect_line(uint8_t first, uint8_t count, float loss = 0.0f);
+			/** Grid of cols x rows starting at first, row-major, 4-neighbourhood. */
+			void connect_grid(uint8_t first, uint8_t cols, uint8_t rows, float loss = 0.0f);
+
+			///////////// Driver side /////////////
+			bool attach(SimRadioDriver* driver);
+			void detach(SimRadioDriver* driver);
+
+			/**
+			 * Transmit a frame from the given driver.
+			 * @return number of bytes sent, -1 if too long,
+			 * -2 if a unicast frame was not acknowledged.
+			 * @param[out] retransmits if not NULL, the hardware
+			 * retransmissions of this frame.
+			 */
+			int transmit(SimRadioDriver* driver, uint8_t dest, uint8_t port, const iovec_t* vec,
+						uint8_t* retransmits = NULL);
+
+			/**
+			 * Wait for a frame for the given driver.
+			 * @param[in] ms timeout; 0 waits forever.
+			 * @return number of bytes received, -1 if the frame did not
+			 * fit into the buffer (frame dropped), -2 on timeout.
+			 */
+			int receive(SimRadioDriver* driver, uint8_t& src, uint8_t& port, uint8_t& dest,
+						void* buf, size_t len, uint32_t ms);
+
+			/** True if a frame is ready for the given driver. */
+			bool available(SimRadioDriver* driver);
+
+			///////////// Statistics /////////////
+			void get_stats(uint8_t node, stats_t& stats);
+			void get_stats_total(stats_t& stats);
+			void reset_stats();
+		};
+	};
+};
+#endif
@@ -0,0 +1,54 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMRADIODRIVER_CPP__
+#define __MESHWORK_SIMULATION_SIMRADIODRIVER_CPP__
+
+#include "Simulation/SimRadioDriver.h"
+
+using Meshwork::Simulation::SimRadioDriver;
+
+bool SimRadioDriver::begin(const void* config) {
+	UNUSED(config);
+	return m_medium->attach(this);
+}
+
+bool SimRadioDriver::end() {
+	m_medium->detach(this);
+	return true;
+}
+
+bool SimRadioDriver::available() {
+	return m_avail = m_medium->available(this);
+}
+
+int SimRadioDriver::send(uint8_t dest, uint8_t port, const iovec_t* vec) {
+	return m_medium->transmit(this, dest, port, vec, &m_retransmits);
+}
+
+int SimRadioDriver::recv(uint8_t& src, uint8_t& port, void* buf, size_t len, uint32_t ms) {
+	uint8_t dest = 0;
+	int result = m_medium->receive(this, src, port, dest, buf, len, ms);
+	if ( result >= 0 )
+		m_dest = dest;
+	m_avail = false;
+	return result;
+}
+#endif
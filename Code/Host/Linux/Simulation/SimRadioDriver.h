@@ -0,0 +1,104 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMRADIODRIVER_H__
+#define __MESHWORK_SIMULATION_SIMRADIODRIVER_H__
+
+#include "Cosa/Types.h"
+#include "Cosa/Wireless.hh"
+#include "Simulation/SimMedium.h"
+
+/**
+ * Wireless::Driver over a SimMedium. Drop-in replacement for the
+ * NRF24L01P driver in host builds: same payload limit and the same
+ * send()/recv() return codes, so NetworkV1 behaves as on the radio.
+ *
+ * Usage (one driver and one NetworkV1 per simulated node):
+ *   SimMedium medium;
+ *   SimRadioDriver rf(&medium, 0xC05A, 1);
+ *   NetworkV1 mesh(&rf, &routeProvider);
+ *   mesh.begin();
+ */
+namespace Meshwork {
+
+	namespace Simulation {
+
+		class SimRadioDriver: public Wireless::Driver {
+		protected:
+			SimMedium* m_medium;
+			uint8_t m_retransmits;
+
+		public:
+			/** Maximum payload; same as NRF24L01P::PAYLOAD_MAX. */
+			static const uint8_t PAYLOAD_MAX = SimMedium::FRAME_MAX;
+
+			SimRadioDriver(SimMedium* medium, int16_t net, uint8_t dev):
+				Wireless::Driver(net, dev),
+				m_medium(medium),
+				m_retransmits(0)
+			{
+			}
+
+			SimMedium* get_medium() {
+				return m_medium;
+			}
+
+			/**
+			 * Attach to the medium under the current device address.
+			 * @return false if the address is taken or invalid.
+			 */
+			virtual bool begin(const void* config = NULL);
+
+			/** Detach from the medium; queued frames are discarded. */
+			virtual bool end();
+
+			virtual bool available();
+
+			/**
+			 * Send message in given null terminated io vector.
+			 * @return number of bytes sent, -1 if the payload exceeds
+			 * PAYLOAD_MAX, -2 if the destination did not acknowledge.
+			 */
+			virtual int send(uint8_t dest, uint8_t port, const iovec_t* vec);
+
+			/**
+			 * Receive message into the given buffer.
+			 * @param[in] ms timeout; 0 waits forever, as on the NRF24L01P.
+			 * @return number of bytes received, -1 if the message does
+			 * not fit into the buffer (message dropped), -2 on timeout.
+			 */
+			virtual int recv(uint8_t& src, uint8_t& port, void* buf, size_t len, uint32_t ms = 0L);
+
+			virtual void get_capabilities(capabilities_t& caps) {
+				caps.payload_max = PAYLOAD_MAX;
+				caps.broadcast = true;
+				caps.rssi = false;
+				caps.lqi = false;
+				caps.retransmits = true;
+			}
+
+			/** Retransmissions of the last send(); the ARC if it was not acknowledged. */
+			virtual int get_retransmit_count() {
+				return m_retransmits;
+			}
+		};
+	};
+};
+#endif
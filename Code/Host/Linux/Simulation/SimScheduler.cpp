@@ -0,0 +1,221 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMSCHEDULER_CPP__
+#define __MESHWORK_SIMULATION_SIMSCHEDULER_CPP__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Simulation/SimScheduler.h"
+
+using Meshwork::Simulation::SimScheduler;
+
+__thread SimScheduler::thread_t* SimScheduler::s_self = NULL;
+
+SimScheduler::SimScheduler():
+	m_now(0),
+	m_order(0),
+	m_threads(NULL),
+	m_current(NULL),
+	m_running(false)
+{
+	pthread_mutex_init(&m_lock, NULL);
+}
+
+SimScheduler::~SimScheduler() {
+	//suspended threads still reference the lock
+	if ( m_threads == NULL )
+		pthread_mutex_destroy(&m_lock);
+}
+
+//must be called with m_lock held
+SimScheduler::thread_t* SimScheduler::create(Entry entry, void* arg) {
+	thread_t* thread = new thread_t;
+	thread->scheduler = this;
+	pthread_cond_init(&thread->cond, NULL);
+	thread->wake = m_now;
+	thread->order = m_order ++;
+	thread->channel = NULL;
+	thread->entry = entry;
+	thread->arg = arg;
+	thread->next = m_threads;
+	m_threads = thread;
+	return thread;
+}
+
+//must be called with m_lock held
+void SimScheduler::remove(thread_t* thread) {
+	for ( thread_t** p = &m_threads; *p != NULL; p = &(*p)->next )
+		if ( *p == thread ) {
+			*p = thread->next;
+			break;
+		}
+	if ( m_current == thread )
+		m_current = NULL;
+}
+
+//must be called with m_lock held
+void SimScheduler::dispatch(thread_t* self) {
+	if ( m_running ) {
+		thread_t* next = NULL;
+		for ( thread_t* t = m_threads; t != NULL; t = t->next )
+			if ( t->wake != NEVER && (next == NULL || t->wake < next->wake ||
+					(t->wake == next->wake && t->order < next->order)) )
+				next = t;
+		if ( next == NULL ) {
+			fprintf(stderr, "SimScheduler: all threads blocked at %llu us\n",
+						(unsigned long long) m_now);
+			abort();
+		}
+		if ( next->wake > m_now )
+			m_now = next->wake;
+		next->wake = NEVER;
+		next->channel = NULL;
+		m_current = next;
+		if ( next != self )
+			pthread_cond_signal(&next->cond);
+	}
+	//after end() the remaining threads stay suspended
+	if ( self != NULL )
+		while ( m_current != self )
+			pthread_cond_wait(&self->cond, &m_lock);
+}
+
+//must be called with m_lock held
+void SimScheduler::block(thread_t* self, const void* channel, uint64_t wake) {
+	self->channel = channel;
+	self->wake = wake < m_now ? m_now : wake;
+	self->order = m_order ++;
+	dispatch(self);
+}
+
+void* SimScheduler::start(void* arg) {
+	thread_t* self = (thread_t*) arg;
+	SimScheduler* scheduler = self->scheduler;
+	s_self = self;
+	pthread_mutex_lock(&scheduler->m_lock);
+	while ( scheduler->m_current != self )
+		pthread_cond_wait(&self->cond, &scheduler->m_lock);
+	pthread_mutex_unlock(&scheduler->m_lock);
+
+	void* result = self->entry(self->arg);
+
+	pthread_mutex_lock(&scheduler->m_lock);
+	scheduler->remove(self);
+	scheduler->dispatch(NULL);
+	pthread_mutex_unlock(&scheduler->m_lock);
+	s_self = NULL;
+	pthread_cond_destroy(&self->cond);
+	delete self;
+	return result;
+}
+
+bool SimScheduler::begin() {
+	pthread_mutex_lock(&m_lock);
+	bool result = !m_running;
+	if ( result ) {
+		m_running = true;
+		s_self = create(NULL, NULL);
+		s_self->wake = NEVER;
+		m_current = s_self;
+	}
+	pthread_mutex_unlock(&m_lock);
+	if ( result )
+		RTC::set_clock(this);
+	return result;
+}
+
+void SimScheduler::end() {
+	if ( !is_simulated() )
+		return;
+	pthread_mutex_lock(&m_lock);
+	m_running = false;
+	remove(s_self);
+	m_current = NULL;
+	pthread_mutex_unlock(&m_lock);
+	pthread_cond_destroy(&s_self->cond);
+	delete s_self;
+	s_self = NULL;
+	RTC::set_clock(NULL);
+}
+
+bool SimScheduler::spawn(Entry entry, void* arg) {
+	pthread_mutex_lock(&m_lock);
+	bool result = m_running;
+	if ( result ) {
+		thread_t* thread = create(entry, arg);
+		pthread_t tid;
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		result = pthread_create(&tid, &attr, start, thread) == 0;
+		pthread_attr_destroy(&attr);
+		if ( !result ) {
+			remove(thread);
+			pthread_cond_destroy(&thread->cond);
+			delete thread;
+		}
+	}
+	pthread_mutex_unlock(&m_lock);
+	return result;
+}
+
+uint64_t SimScheduler::get_micros() {
+	pthread_mutex_lock(&m_lock);
+	uint64_t now = m_now;
+	pthread_mutex_unlock(&m_lock);
+	return now;
+}
+
+void SimScheduler::sleep_until(uint64_t us) {
+	wait(NULL, us);
+}
+
+void SimScheduler::wait(const void* channel, uint64_t deadline, pthread_mutex_t* lock) {
+	if ( !is_simulated() ) {
+		fprintf(stderr, "SimScheduler: blocking call from a thread outside the simulation\n");
+		abort();
+	}
+	//no other simulated thread runs until this one blocks,
+	//so releasing the caller's lock first does not lose a notify()
+	if ( lock != NULL )
+		pthread_mutex_unlock(lock);
+	pthread_mutex_lock(&m_lock);
+	block(s_self, channel, deadline);
+	pthread_mutex_unlock(&m_lock);
+	if ( lock != NULL )
+		pthread_mutex_lock(lock);
+}
+
+void SimScheduler::notify(const void* channel, uint64_t at) {
+	if ( channel == NULL )
+		return;
+	pthread_mutex_lock(&m_lock);
+	if ( at < m_now )
+		at = m_now;
+	for ( thread_t* t = m_threads; t != NULL; t = t->next )
+		if ( t->channel == channel && at < t->wake ) {
+			t->wake = at;
+			t->order = m_order ++;
+		}
+	pthread_mutex_unlock(&m_lock);
+}
+#endif
@@ -0,0 +1,145 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+#ifndef __MESHWORK_SIMULATION_SIMSCHEDULER_H__
+#define __MESHWORK_SIMULATION_SIMSCHEDULER_H__
+
+#include <pthread.h>
+
+#include "Cosa/Types.h"
+#include "Cosa/RTC.hh"
+
+/**
+ * Discrete-event scheduler with virtual time. Installed as the RTC
+ * clock, it drives RTC::millis(), RTC::delay(), Watchdog and
+ * Power::sleep(), and therefore Meshwork::Time::delay() and the
+ * timeouts checked with Meshwork::Time::passed().
+ *
+ * Simulated threads (the thread calling begin() and those created
+ * with spawn()) run one at a time. A thread keeps running, without
+ * virtual time passing, until it blocks in sleep_until() or wait();
+ * the scheduler then advances the clock to the earliest pending
+ * wake-up and resumes that thread. Ties are resolved in the order
+ * the wake-ups were scheduled, so a run is deterministic for a given
+ * topology and medium seed, and idle time costs nothing.
+ *
+ * Usage:
+ *   SimScheduler scheduler;
+ *   SimMedium medium;
+ *   medium.set_scheduler(&scheduler);
+ *   scheduler.begin();
+ *   scheduler.spawn(node_loop, &node);
+ *   ...
+ *   scheduler.end();
+ */
+namespace Meshwork {
+
+	namespace Simulation {
+
+		class SimScheduler: public RTC::Clock {
+		public:
+			/** Wake-up time of a thread waiting without timeout. */
+			static const uint64_t NEVER = UINT64_MAX;
+
+			typedef void* (*Entry)(void* arg);
+
+		protected:
+			struct thread_t {
+				SimScheduler* scheduler;
+				pthread_cond_t cond;
+				uint64_t wake;			//us, NEVER if blocked without timeout
+				uint32_t order;			//tie breaker for equal wake times
+				const void* channel;	//wait() channel, NULL if sleeping
+				Entry entry;
+				void* arg;
+				thread_t* next;
+			};
+
+			static __thread thread_t* s_self;
+
+			pthread_mutex_t m_lock;
+			uint64_t m_now;
+			uint32_t m_order;
+			thread_t* m_threads;
+			thread_t* m_current;
+			bool m_running;
+
+			thread_t* create(Entry entry, void* arg);
+			void remove(thread_t* thread);
+			//hand over to the next thread; blocks self (if any) until resumed
+			void dispatch(thread_t* self);
+			void block(thread_t* self, const void* channel, uint64_t wake);
+			static void* start(void* arg);
+
+		public:
+			SimScheduler();
+			~SimScheduler();
+
+			/**
+			 * Make the calling thread the first simulated thread and
+			 * install the scheduler as the RTC clock.
+			 * @return false if already running.
+			 */
+			bool begin();
+
+			/**
+			 * Stop the simulation: the calling thread leaves it, the
+			 * monotonic RTC clock is restored and all other simulated
+			 * threads stay suspended.
+			 */
+			void end();
+
+			/**
+			 * Create a simulated thread. It starts at the current
+			 * virtual time once the caller blocks.
+			 * @return false if the thread could not be created.
+			 */
+			bool spawn(Entry entry, void* arg);
+
+			/** True if the calling thread is a simulated thread. */
+			bool is_simulated() {
+				return s_self != NULL && s_self->scheduler == this;
+			}
+
+			/** Virtual time, us. */
+			virtual uint64_t get_micros();
+
+			/** Block the calling simulated thread until the given time. */
+			virtual void sleep_until(uint64_t us);
+
+			/**
+			 * Block the calling simulated thread until notify() on the
+			 * given channel or the deadline. The lock, if given, is
+			 * released while blocked. Callers re-check their condition.
+			 * @param[in] channel any address identifying the event.
+			 * @param[in] deadline us, or NEVER.
+			 * @param[in] lock mutex held by the caller, or NULL.
+			 */
+			void wait(const void* channel, uint64_t deadline, pthread_mutex_t* lock = NULL);
+
+			/**
+			 * Wake the threads waiting on the given channel at the given
+			 * time (not before the current time).
+			 */
+			void notify(const void* channel, uint64_t at);
+		};
+	};
+};
+#endif
@@ -0,0 +1,757 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Host test for NetworkV1 over SimMedium in virtual time. The nodes
+ * are built in a line from TEST_FIRST_NODE; the first one is the
+ * originator and sends from the main thread, the others run
+ * NetworkV1::recv() loops. A bare SimRadioDriver (TEST_RAW_NODE) sends
+ * hand-made frames where a case needs a retransmission.
+ * Cases:
+ *   - FLOOD over 1 to TEST_HOPS_MAX relays with lossy links: at least
+ *     TEST_DELIVERY_MIN percent of the messages arrive, every send()
+ *     that returned OK was delivered and, with
+ *     MW_SUPPORT_ADAPTIVE_TIMEOUT, no message takes as long as a full
+ *     FLOOD ACK timeout, which is what a lost discovery reply costs
+ *     otherwise
+ *   - a retransmitted DIRECT frame is delivered once and ACKed again
+ *     (MW_SUPPORT_DUPLICATE_DETECTION), with the same ACK payload and
+ *     without asking the ACKProvider again (MW_SUPPORT_ACK_REPLAY)
+ *   - a reply to a late copy of a FLOOD discovery is not taken for the
+ *     ACK of the payload that follows it over the discovered route
+ *   - a ROUTED send over a cut link fails with ERROR_ROUTE_BROKEN before
+ *     its ACK timeout, and the route is marked failed; with a relay
+ *     window the report may come after the send has failed, and still
+ *     marks the route (MW_SUPPORT_ROUTE_ERROR)
+ *   - the same with a way around the cut link known to the relay: the
+ *     message is delivered once, with OK, and with a relay window only
+ *     once the relay has given up on the next hop
+ *     (MW_SUPPORT_ROUTE_REPAIR)
+ *   - messages longer than PAYLOAD_MAX sent DIRECT and over 2 relays
+ *     with lossy links arrive intact and once, and only with OK if they
+ *     did (MW_SUPPORT_FRAGMENTATION)
+ *   - a frame that arrives while send() waits for its ACK is returned by
+ *     the next recv() (MW_SUPPORT_RECV_QUEUE)
+ *   - the messages of a restarted originator are not taken for
+ *     duplicates of the ones it has sent before
+ *   - FLOOD with send_async() over 2 relays with lossy links: every
+ *     send completes once, and only with OK if it was delivered
+ *     (MW_SUPPORT_ASYNC_SEND)
+ *   - the same with the pending-send table filled up: one more send is
+ *     rejected with ERROR_SEND_QUEUE_FULL, and those in flight complete
+ *
+ * Usage: Test_NetworkV1 [-n messages] [-l loss] [-s seed]
+ * Exits with 0 if all checks passed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Cosa/Types.h"
+#include "Cosa/RTC.hh"
+#include "Meshwork.h"
+#include "Meshwork/L3/Network.h"
+#include "Meshwork/L3/NetworkV1/NetworkV1.h"
+#include "Meshwork/L3/NetworkV1/RouteCache.h"
+#include "Meshwork/L3/NetworkV1/CachingRouteProvider.h"
+#include "Simulation/SimMedium.h"
+#include "Simulation/SimRadioDriver.h"
+#include "Simulation/SimScheduler.h"
+
+using Meshwork::L3::Network;
+using Meshwork::L3::NetworkV1::NetworkV1;
+using Meshwork::L3::NetworkV1::RouteCache;
+using Meshwork::L3::NetworkV1::CachingRouteProvider;
+using Meshwork::Simulation::SimMedium;
+using Meshwork::Simulation::SimRadioDriver;
+using Meshwork::Simulation::SimScheduler;
+
+#define TEST_NETWORK_ID		0xC05A
+#define TEST_PORT			10
+#define TEST_FIRST_NODE		1
+#define TEST_RAW_NODE		100
+#define TEST_MSG_MAX		1000
+#define TEST_HOPS_MAX		4
+#define TEST_NODES			(TEST_HOPS_MAX + 2)
+//percent of the messages that must arrive
+#define TEST_DELIVERY_MIN	95
+//scenario, message index (2)
+#define TEST_PAYLOAD		3
+//fragmented messages and their length, header and filler
+#define TEST_FRAGMENTED_MSGS	20
+#define TEST_FRAGMENTED_LEN		200
+#define TEST_SETTLE_MS		20000
+//longer than any send with all its retries
+#define TEST_SEND_MAX_MS	200000
+//messages sent before and after a restart; fewer than the duplicate detection remembers
+#define TEST_RESTART_MSGS	4
+//rounds of filling the pending-send table
+#define TEST_INFLIGHT_ROUNDS	50
+//FLOOD messages to a destination whose payloads are lost
+#define TEST_DISCOVERY_MSGS	10
+//time an originator waits in its own recv()
+#define TEST_POLL_MS		100
+
+//ACK payloads are handed out only by the cases that check them
+static bool s_ackPayload = false;
+
+class TestACKProvider: public Network::ACKProvider {
+public:
+	uint8_t count;//ACK payloads handed out
+
+	TestACKProvider(): count(0) {}
+
+	int returnACKPayload(uint8_t src, uint8_t port, void* buf, uint8_t len, void* bufACK, size_t lenACK) {
+		UNUSED(src);
+		UNUSED(port);
+		UNUSED(buf);
+		UNUSED(len);
+		if ( !s_ackPayload || lenACK < 1 )
+			return 0;
+		((uint8_t*) bufACK)[0] = ++ count;
+		return 1;
+	}
+};
+
+struct node_t {
+	SimRadioDriver* rf;
+	NetworkV1* nwk;
+	TestACKProvider ack;
+};
+
+static SimScheduler scheduler;
+static SimMedium medium;
+static node_t nodes[TEST_NODES];
+static SimRadioDriver* raw;
+
+static uint8_t s_scenario = 0;
+static uint64_t s_start[TEST_MSG_MAX];
+static uint64_t s_arrival[TEST_MSG_MAX];
+static uint8_t s_deliveries[TEST_MSG_MAX];
+static uint16_t s_damaged = 0;//messages delivered with a wrong filler
+static int s_result[TEST_MSG_MAX];
+
+#if MW_SUPPORT_ASYNC_SEND
+static uint16_t s_async = 0;//messages started asynchronously in the scenario
+static uint8_t s_handle[TEST_MSG_MAX];
+static uint8_t s_completions[TEST_MSG_MAX];
+
+class TestSendListener: public NetworkV1::SendListener {
+public:
+	void send_completed(uint8_t handle, Network::msg_l3_status_t result, void* bufACK, size_t lenACK) {
+		UNUSED(bufACK);
+		UNUSED(lenACK);
+		//the latest message with the handle; handles are reused after 256 sends
+		for ( uint16_t i = s_async; i > 0; i -- ) {
+			if ( s_handle[i - 1] == handle ) {
+				s_result[i - 1] = result;
+				s_completions[i - 1] ++;
+				return;
+			}
+		}
+	}
+};
+
+static TestSendListener s_listener;
+#endif
+
+static void* receiver(void* arg) {
+	node_t* node = (node_t*) arg;
+	for ( ;; ) {
+		uint8_t src, port;
+		uint8_t data[NetworkV1::RECV_PAYLOAD_MAX];
+		size_t len = sizeof(data);
+		int result = node->nwk->recv(src, port, data, len, 0, &node->ack);
+		if ( result != Network::OK || port != TEST_PORT || len < TEST_PAYLOAD || data[0] != s_scenario )
+			continue;
+		uint16_t index = data[1] | (data[2] << 8);
+		if ( index >= TEST_MSG_MAX )
+			continue;
+		bool intact = true;
+		for ( size_t i = TEST_PAYLOAD; i < len && intact; i ++ )
+			intact = data[i] == (uint8_t) (index + i);
+		if ( !intact ) {
+			s_damaged ++;
+			continue;
+		}
+		if ( s_arrival[index] == 0 )
+			s_arrival[index] = scheduler.get_micros();
+		s_deliveries[index] ++;
+	}
+	return NULL;
+}
+
+///////////// Helpers /////////////
+static uint32_t s_seed;
+static char s_case[40];
+
+#define CHECK(cond, msg, ...) \
+	do { if ( !(cond) ) { \
+		printf("[Test_NetworkV1] FAILED %s (seed %u): " msg "\n", s_case, s_seed, __VA_ARGS__); \
+		return false; \
+	} } while (0)
+
+//new scenario over a line of count nodes from the originator on
+static void setup(const char* name, uint8_t count, float loss) {
+	snprintf(s_case, sizeof(s_case), "%s", name);
+	medium.disconnect_all();
+	medium.connect_line(TEST_FIRST_NODE, count, loss);
+	s_scenario ++;
+	s_ackPayload = false;
+	s_damaged = 0;
+	memset(s_start, 0, sizeof(s_start));
+	memset(s_arrival, 0, sizeof(s_arrival));
+	memset(s_deliveries, 0, sizeof(s_deliveries));
+	memset(s_result, 0, sizeof(s_result));
+#if MW_SUPPORT_ASYNC_SEND
+	s_async = 0;
+	memset(s_completions, 0, sizeof(s_completions));
+#endif
+}
+
+//the header of message index, followed by a filler up to len
+static void message(uint8_t* data, uint16_t index, size_t len = TEST_PAYLOAD) {
+	for ( size_t i = TEST_PAYLOAD; i < len; i ++ )
+		data[i] = (uint8_t) (index + i);
+	data[0] = s_scenario;
+	data[1] = index & 0xff;
+	data[2] = index >> 8;
+}
+
+static int send(uint8_t delivery, uint8_t dst, uint16_t index, size_t len = TEST_PAYLOAD) {
+	uint8_t data[NetworkV1::RECV_PAYLOAD_MAX];
+	message(data, index, len);
+	size_t lenACK = 0;
+	s_start[index] = scheduler.get_micros();
+	s_result[index] = nodes[0].nwk->send(delivery, NetworkV1::DEFAULT_SEND_RETRY, dst, TEST_PORT,
+										data, len, NULL, lenACK);
+	return s_result[index];
+}
+
+#if MW_SUPPORT_ASYNC_SEND
+static int send_async(uint8_t delivery, uint8_t dst, uint16_t index) {
+	uint8_t data[TEST_PAYLOAD];
+	message(data, index);
+	s_start[index] = scheduler.get_micros();
+	s_async = index + 1;
+	int result = nodes[0].nwk->send_async(delivery, NetworkV1::DEFAULT_SEND_RETRY, dst, TEST_PORT,
+										data, sizeof(data), &s_listener, s_handle[index]);
+	if ( result != Network::OK ) {
+		s_result[index] = result;
+		s_async = index;//not started, so no handle
+	}
+	return result;
+}
+
+//drives the originator until its asynchronous sends have completed; false if they did not
+static bool wait_async() {
+	uint64_t deadline = scheduler.get_micros() + (uint64_t) TEST_SEND_MAX_MS * 1000;
+	while ( nodes[0].nwk->get_pending_count() > 0 && scheduler.get_micros() < deadline ) {
+		uint8_t src, port;
+		uint8_t data[NetworkV1::PAYLOAD_MAX];
+		size_t len = sizeof(data);
+		nodes[0].nwk->recv(src, port, data, len, TEST_POLL_MS, NULL);
+	}
+	return nodes[0].nwk->get_pending_count() == 0;
+}
+#endif
+
+#if MW_SUPPORT_DUPLICATE_DETECTION || MW_SUPPORT_RECV_QUEUE
+//a DIRECT frame of message index from the bare driver, as a retransmission would send it again
+static bool send_raw(uint8_t dst, uint8_t seq, uint16_t index) {
+	uint8_t frame[sizeof(NetworkV1::nwk_ctrl_t) + TEST_PAYLOAD] = {seq, Network::DELIVERY_DIRECT};
+	message(frame + sizeof(NetworkV1::nwk_ctrl_t), index);
+	Wireless::Driver* driver = raw;
+	return driver->send(dst, TEST_PORT, frame, sizeof(frame)) > 0;
+}
+
+//the DIRECT ACK for seq at the bare driver; returns the first ACK payload byte, 0 if none, -1 if no ACK
+static int recv_raw_ack(uint8_t seq) {
+	uint64_t deadline = scheduler.get_micros() + (uint64_t) NetworkV1::TIMEOUT_ACK_DIRECT * 1000;
+	while ( scheduler.get_micros() < deadline ) {
+		uint8_t src, port;
+		uint8_t frame[NetworkV1::FRAME_MAX];
+		int len = raw->recv(src, port, frame, sizeof(frame), NetworkV1::TIMEOUT_ACK_RECEIVE);
+		if ( len >= (int) sizeof(NetworkV1::nwk_ctrl_t) && port == TEST_PORT && frame[0] == seq &&
+				frame[1] == (Network::DELIVERY_DIRECT | NetworkV1::ACK) )
+			return len > (int) sizeof(NetworkV1::nwk_ctrl_t) ? frame[sizeof(NetworkV1::nwk_ctrl_t)] : 0;
+	}
+	return -1;
+}
+#endif
+
+#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+static bool s_rawDestination = false;
+
+//a FLOOD destination on the bare driver whose payloads are all lost, while its replies to two copies
+//of each discovery get through; the second one arrives while the originator waits for the payload's ACK
+static void* raw_destination(void* arg) {
+	UNUSED(arg);
+	Wireless::Driver* driver = raw;
+	uint8_t reply[NetworkV1::FRAME_MAX];
+	int replyLen = 0;
+	uint8_t replyTo = 0;
+	while ( s_rawDestination ) {
+		uint8_t src, port;
+		uint8_t frame[NetworkV1::FRAME_MAX - 1];
+		int len = raw->recv(src, port, frame, sizeof(frame), TEST_POLL_MS);
+		if ( len < (int) sizeof(NetworkV1::nwk_ctrl_t) || port != TEST_PORT || (frame[1] & NetworkV1::ACK) )
+			continue;
+		if ( frame[1] & Network::DELIVERY_FLOOD ) {
+			//SEQ | DELIVERY_FLOOD | Node Count X | SRCID | Node 1 | ... | Node X | DSTID, without payload
+			uint8_t hopCount = frame[2];
+			if ( hopCount == 0 || len != 5 + hopCount || frame[4 + hopCount] != TEST_RAW_NODE )
+				continue;
+			//answered over the route it has taken, as NetworkV1 does
+			memcpy(reply, frame, len);
+			reply[1] = Network::DELIVERY_ROUTED | NetworkV1::ACK;
+			reply[len] = 0;//breadcrumbs
+			replyLen = len + 1;
+			replyTo = src;
+			driver->send(replyTo, TEST_PORT, reply, replyLen);
+		} else if ( replyLen > 0 ) {
+			//the payload over the discovered route is lost, and the reply to a later copy comes instead
+			driver->send(replyTo, TEST_PORT, reply, replyLen);
+			replyLen = 0;
+		}
+	}
+	return NULL;
+}
+#endif
+
+///////////// Cases /////////////
+static bool test_flood(uint8_t hops, uint16_t count, float loss) {
+	uint8_t dst = TEST_FIRST_NODE + hops + 1;
+	setup("FLOOD", hops + 2, loss);
+	snprintf(s_case, sizeof(s_case), "FLOOD over %d hops", hops);
+
+	for ( uint16_t i = 0; i < count; i ++ )
+		send(Network::DELIVERY_FLOOD, dst, i);
+	//let late frames (relays, ACKs) drain
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	uint16_t delivered = 0;
+	uint64_t slowest = 0;
+	for ( uint16_t i = 0; i < count; i ++ ) {
+		CHECK(s_result[i] != Network::OK || s_arrival[i] != 0, "message %d acknowledged but not delivered", i);
+		if ( s_arrival[i] == 0 )
+			continue;
+		delivered ++;
+		if ( s_arrival[i] - s_start[i] > slowest )
+			slowest = s_arrival[i] - s_start[i];
+	}
+	CHECK(delivered * 100 >= (uint32_t) count * TEST_DELIVERY_MIN, "%d of %d messages delivered, expected %d%%",
+			delivered, count, TEST_DELIVERY_MIN);
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+	CHECK(slowest < (uint64_t) NetworkV1::TIMEOUT_ACK_FLOOD * 1000, "slowest message took %u ms",
+			(uint32_t) (slowest / 1000));
+#endif
+	printf("[Test_NetworkV1] %s: %d of %d delivered, slowest %u ms\n",
+			s_case, delivered, count, (uint32_t) (slowest / 1000));
+	return true;
+}
+
+#if MW_SUPPORT_DUPLICATE_DETECTION
+static bool test_duplicate() {
+	uint8_t dst = TEST_FIRST_NODE + 1;
+	setup("retransmitted DIRECT frame", 2, 0.0f);
+	medium.connect(TEST_RAW_NODE, dst);
+
+	//the second copy is what the originator sends when our ACK is lost
+	for ( int i = 0; i < 2; i ++ ) {
+		CHECK(send_raw(dst, s_scenario, 0), "copy %d not sent", i + 1);
+		CHECK(recv_raw_ack(s_scenario) >= 0, "copy %d not acknowledged", i + 1);
+	}
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+	CHECK(s_deliveries[0] == 1, "delivered %d times", s_deliveries[0]);
+	printf("[Test_NetworkV1] %s: delivered once, acknowledged twice\n", s_case);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_ACK_REPLAY
+static bool test_ack_replay() {
+	uint8_t dst = TEST_FIRST_NODE + 1;
+	setup("ACK replay", 2, 0.0f);
+	medium.connect(TEST_RAW_NODE, dst);
+	s_ackPayload = true;
+
+	uint8_t asked = nodes[1].ack.count;
+	int ack[2];
+	for ( int i = 0; i < 2; i ++ ) {
+		CHECK(send_raw(dst, s_scenario, 0), "copy %d not sent", i + 1);
+		ack[i] = recv_raw_ack(s_scenario);
+		CHECK(ack[i] > 0, "copy %d acknowledged without payload: %d", i + 1, ack[i]);
+	}
+	asked = nodes[1].ack.count - asked;
+	s_ackPayload = false;
+	CHECK(ack[1] == ack[0], "retransmission acknowledged with %d, first copy with %d", ack[1], ack[0]);
+	CHECK(asked == 1, "ACKProvider asked %d times", asked);
+	printf("[Test_NetworkV1] %s: the retransmission got the same ACK payload\n", s_case);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_ASYNC_SEND
+static bool test_async(uint16_t count, float loss) {
+	uint8_t dst = TEST_FIRST_NODE + 3;
+	setup("send_async FLOOD over 2 hops", 4, loss);
+
+	for ( uint16_t i = 0; i < count; i ++ ) {
+		CHECK(send_async(Network::DELIVERY_FLOOD, dst, i) == Network::OK, "message %d not started: %d", i, s_result[i]);
+		CHECK(wait_async(), "message %d not completed", i);
+	}
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	uint16_t delivered = 0;
+	for ( uint16_t i = 0; i < count; i ++ ) {
+		CHECK(s_completions[i] == 1, "message %d completed %d times", i, s_completions[i]);
+		CHECK(s_result[i] != Network::OK || s_arrival[i] != 0, "message %d acknowledged but not delivered", i);
+		if ( s_arrival[i] != 0 )
+			delivered ++;
+	}
+	CHECK(delivered * 100 >= (uint32_t) count * TEST_DELIVERY_MIN, "%d of %d messages delivered, expected %d%%",
+			delivered, count, TEST_DELIVERY_MIN);
+	printf("[Test_NetworkV1] %s: %d of %d delivered\n", s_case, delivered, count);
+	return true;
+}
+
+static bool test_inflight(float loss) {
+	uint8_t dst[] = {TEST_FIRST_NODE + 1, TEST_FIRST_NODE + 3};
+	uint8_t delivery[] = {Network::DELIVERY_DIRECT, Network::DELIVERY_FLOOD};
+	setup("sends in flight", 4, loss);
+
+	uint16_t count = 0;
+	uint8_t inflight = 0;
+	for ( uint16_t round = 0; round < TEST_INFLIGHT_ROUNDS; round ++ ) {
+		//to the neighbour and over 2 relays in turn, until the pending table is full
+		uint8_t started = 0;
+		while ( send_async(delivery[count % 2], dst[count % 2], count) == Network::OK ) {
+			count ++;
+			started ++;
+		}
+		CHECK(s_result[count] == Network::ERROR_SEND_QUEUE_FULL, "send %d rejected with %d", count, s_result[count]);
+		CHECK(started > 1 && (inflight == 0 || started == inflight), "%d sends started in round %d", started, round);
+		inflight = started;
+		s_result[count] = 0;
+		CHECK(wait_async(), "sends of round %d not completed", round);
+	}
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	uint16_t delivered = 0;
+	for ( uint16_t i = 0; i < count; i ++ ) {
+		CHECK(s_completions[i] == 1, "message %d completed %d times", i, s_completions[i]);
+		CHECK(s_result[i] != Network::OK || s_arrival[i] != 0, "message %d acknowledged but not delivered", i);
+		if ( s_arrival[i] != 0 )
+			delivered ++;
+	}
+	CHECK(delivered * 100 >= (uint32_t) count * TEST_DELIVERY_MIN, "%d of %d messages delivered, expected %d%%",
+			delivered, count, TEST_DELIVERY_MIN);
+	printf("[Test_NetworkV1] %s: %d at a time, %d of %d delivered\n", s_case, inflight, delivered, count);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_RECV_QUEUE
+static bool test_recv_queue() {
+	uint8_t dst = TEST_FIRST_NODE + 1;
+	setup("frame received during an ACK wait", 2, 0.0f);
+	medium.connect(TEST_RAW_NODE, TEST_FIRST_NODE);
+
+	//waits in the originator's radio until its send() reads it while waiting for the ACK
+	CHECK(send_raw(TEST_FIRST_NODE, s_scenario, 1), "frame %d not sent", 1);
+	CHECK(send(Network::DELIVERY_DIRECT, dst, 0) == Network::OK, "message %d failed: %d", 0, s_result[0]);
+
+	uint8_t src, port;
+	uint8_t data[NetworkV1::PAYLOAD_MAX];
+	size_t len = sizeof(data);
+	int result = nodes[0].nwk->recv(src, port, data, len, TEST_POLL_MS, NULL);
+	CHECK(result == Network::OK, "next recv() returned %d", result);
+	CHECK(src == TEST_RAW_NODE && port == TEST_PORT && len == TEST_PAYLOAD && data[0] == s_scenario && data[1] == 1,
+			"next recv() returned another frame from %d", src);
+	CHECK(recv_raw_ack(s_scenario) >= 0, "frame %d not acknowledged", 1);
+	printf("[Test_NetworkV1] %s: returned by the next recv()\n", s_case);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_FRAGMENTATION
+static bool test_fragmentation(uint8_t delivery, uint8_t hops, const char* name, float loss) {
+	uint8_t dst = TEST_FIRST_NODE + hops + 1;
+	setup(name, hops + 2, loss);
+
+	for ( uint16_t i = 0; i < TEST_FRAGMENTED_MSGS; i ++ )
+		send(delivery, dst, i, TEST_FRAGMENTED_LEN);
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	uint16_t delivered = 0;
+	for ( uint16_t i = 0; i < TEST_FRAGMENTED_MSGS; i ++ ) {
+		CHECK(s_result[i] != Network::OK || s_arrival[i] != 0, "message %d acknowledged but not delivered", i);
+		CHECK(s_deliveries[i] <= 1, "message %d delivered %d times", i, s_deliveries[i]);
+		if ( s_arrival[i] != 0 )
+			delivered ++;
+	}
+	CHECK(s_damaged == 0, "%d messages damaged", s_damaged);
+	CHECK(delivered * 100 >= (uint32_t) TEST_FRAGMENTED_MSGS * TEST_DELIVERY_MIN, "%d of %d messages delivered, expected %d%%",
+			delivered, TEST_FRAGMENTED_MSGS, TEST_DELIVERY_MIN);
+	printf("[Test_NetworkV1] %s: %d of %d delivered intact\n", s_case, delivered, TEST_FRAGMENTED_MSGS);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+static bool test_discovery_replies(bool async) {
+	setup(async ? "late discovery replies, send_async" : "late discovery replies", 2, 0.0f);
+	medium.connect(TEST_FIRST_NODE + 1, TEST_RAW_NODE);
+	s_rawDestination = true;
+	scheduler.spawn(raw_destination, NULL);
+
+	for ( uint16_t i = 0; i < TEST_DISCOVERY_MSGS; i ++ ) {
+	#if MW_SUPPORT_ASYNC_SEND
+		if ( async ) {
+			CHECK(send_async(Network::DELIVERY_FLOOD, TEST_RAW_NODE, i) == Network::OK, "message %d not started: %d", i, s_result[i]);
+			CHECK(wait_async(), "message %d not completed", i);
+			continue;
+		}
+	#endif
+		send(Network::DELIVERY_FLOOD, TEST_RAW_NODE, i);
+	}
+	s_rawDestination = false;
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	uint16_t acknowledged = 0;
+	for ( uint16_t i = 0; i < TEST_DISCOVERY_MSGS; i ++ )
+		if ( s_result[i] == Network::OK )
+			acknowledged ++;
+
+	//none delivered, so none may be acknowledged
+	CHECK(acknowledged == 0, "%d of %d lost messages acknowledged", acknowledged, TEST_DISCOVERY_MSGS);
+	printf("[Test_NetworkV1] %s: none of %d lost messages acknowledged\n", s_case, TEST_DISCOVERY_MSGS);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_ROUTE_ERROR
+//with a relay window, the relay reports the link only once it has given up, maybe after the originator
+static bool test_route_error(uint16_t window) {
+	uint8_t dst = TEST_FIRST_NODE + 3;
+	setup(window == 0 ? "ROUTED over a cut link" : "ROUTED over a cut link, relay window", 4, 0.0f);
+	RouteCache cache(NULL);
+	CachingRouteProvider provider(&cache, CachingRouteProvider::UPDATE_REMOVE_ON_QOS_MIN);
+	provider.set_address(TEST_FIRST_NODE);
+	uint8_t hops[] = {TEST_FIRST_NODE + 1, TEST_FIRST_NODE + 2};
+	NetworkV1::route_t route = {sizeof(hops), TEST_FIRST_NODE, hops, dst};
+	cache.add_route_entry(&route, false, Network::QOS_LEVEL_MAX);
+	nodes[0].nwk->set_route_advisor(&provider);
+	#if MW_SUPPORT_HOP_RELIABLE
+	for ( uint8_t i = 1; i < TEST_NODES; i ++ )
+		nodes[i].nwk->set_relay_window(window);
+	#endif
+	//the last relay cannot reach the destination any more
+	medium.disconnect(TEST_FIRST_NODE + 2, dst);
+
+	uint64_t start = scheduler.get_micros();
+	int result = send(Network::DELIVERY_ROUTED, dst, 0);
+	uint32_t elapsed = (uint32_t) ((scheduler.get_micros() - start) / 1000);
+	//a late route error is taken by the next recv()
+	uint64_t deadline = scheduler.get_micros() + (uint64_t) TEST_SETTLE_MS * 1000;
+	while ( scheduler.get_micros() < deadline ) {
+		uint8_t src, port;
+		uint8_t data[NetworkV1::PAYLOAD_MAX];
+		size_t len = sizeof(data);
+		nodes[0].nwk->recv(src, port, data, len, TEST_POLL_MS, NULL);
+	}
+	RouteCache::route_entry_t* entry = cache.get_route_entry(&route);
+	nodes[0].nwk->set_route_advisor(NULL);
+	#if MW_SUPPORT_HOP_RELIABLE
+	for ( uint8_t i = 1; i < TEST_NODES; i ++ )
+		nodes[i].nwk->set_relay_window(NetworkV1::TIMEOUT_RELAY_RETRY);
+	#endif
+
+	if ( window == 0 ) {
+		CHECK(result == Network::ERROR_ROUTE_BROKEN, "send() returned %d", result);
+		CHECK(elapsed < NetworkV1::TIMEOUT_ACK_ROUTED, "send() took %u ms", elapsed);
+	} else {
+		CHECK(result == Network::ERROR_ROUTE_BROKEN || result == Network::ERROR_ACK_NOT_RECEIVED, "send() returned %d", result);
+	}
+	CHECK(entry == NULL || entry->qos == Network::QOS_LEVEL_MIN, "route left with QoS %d", entry->qos);
+	printf("[Test_NetworkV1] %s: send() returned %d after %u ms, route marked failed\n", s_case, result, elapsed);
+	return true;
+}
+#endif
+
+#if MW_SUPPORT_ROUTE_REPAIR
+//with a relay window, the relay repairs the route only once its retries to the next hop are used up
+static bool test_route_repair(uint16_t window) {
+	uint8_t relay = TEST_FIRST_NODE + 2;
+	uint8_t dst = TEST_FIRST_NODE + 3;
+	uint8_t detour = TEST_FIRST_NODE + 4;
+	setup(window == 0 ? "ROUTED around a cut link" : "ROUTED around a cut link, relay window", 4, 0.0f);
+	//the originator knows the line, the last relay also a way around its link to the destination
+	RouteCache cache(NULL);
+	CachingRouteProvider provider(&cache, CachingRouteProvider::UPDATE_REMOVE_ON_QOS_MIN);
+	provider.set_address(TEST_FIRST_NODE);
+	uint8_t hops[] = {TEST_FIRST_NODE + 1, relay};
+	NetworkV1::route_t route = {sizeof(hops), TEST_FIRST_NODE, hops, dst};
+	cache.add_route_entry(&route, false, Network::QOS_LEVEL_MAX);
+	RouteCache relayCache(NULL);
+	CachingRouteProvider relayProvider(&relayCache, CachingRouteProvider::UPDATE_REMOVE_ON_QOS_MIN);
+	relayProvider.set_address(relay);
+	uint8_t relayHops[] = {detour};
+	NetworkV1::route_t relayRoute = {sizeof(relayHops), relay, relayHops, dst};
+	relayCache.add_route_entry(&relayRoute, false, Network::QOS_LEVEL_MAX);
+	nodes[0].nwk->set_route_advisor(&provider);
+	nodes[2].nwk->set_route_advisor(&relayProvider);
+	#if MW_SUPPORT_HOP_RELIABLE
+	for ( uint8_t i = 1; i < TEST_NODES; i ++ )
+		nodes[i].nwk->set_relay_window(window);
+	#endif
+	medium.connect(relay, detour);
+	medium.connect(detour, dst);
+	medium.disconnect(relay, dst);
+
+	send(Network::DELIVERY_ROUTED, dst, 0);
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+	nodes[0].nwk->set_route_advisor(NULL);
+	nodes[2].nwk->set_route_advisor(NULL);
+	#if MW_SUPPORT_HOP_RELIABLE
+	for ( uint8_t i = 1; i < TEST_NODES; i ++ )
+		nodes[i].nwk->set_relay_window(NetworkV1::TIMEOUT_RELAY_RETRY);
+	#endif
+
+	CHECK(s_deliveries[0] == 1, "message delivered %d times", s_deliveries[0]);
+	uint32_t elapsed = (uint32_t) ((s_arrival[0] - s_start[0]) / 1000);
+	if ( window == 0 )
+		CHECK(s_result[0] == Network::OK, "send() returned %d", s_result[0]);
+	else
+		CHECK(elapsed >= window, "repaired after %u ms, before the relay window", elapsed);
+	printf("[Test_NetworkV1] %s: send() returned %d, delivered after %u ms\n", s_case, s_result[0], elapsed);
+	return true;
+}
+#endif
+
+static bool test_restart() {
+	uint8_t dst = TEST_FIRST_NODE + 1;
+	setup("restarted originator", 2, 0.0f);
+
+	//restarted before each batch, so that both start from the same state
+	for ( uint16_t i = 0; i < 2 * TEST_RESTART_MSGS; i ++ ) {
+		if ( i % TEST_RESTART_MSGS == 0 ) {
+			node_t* node = &nodes[0];
+			//a fresh instance, as after a reboot; the old one is left behind unused
+			node->nwk->end();
+			node->nwk = new NetworkV1(node->rf, NULL);
+			node->nwk->begin();
+		}
+		send(Network::DELIVERY_DIRECT, dst, i);
+	}
+	Meshwork::Time::delay(TEST_SETTLE_MS);
+
+	for ( uint16_t i = 0; i < 2 * TEST_RESTART_MSGS; i ++ ) {
+		CHECK(s_result[i] == Network::OK, "message %d failed: %d", i, s_result[i]);
+		CHECK(s_deliveries[i] == 1, "message %d delivered %d times", i, s_deliveries[i]);
+	}
+	printf("[Test_NetworkV1] %s: %d messages before and after the restart delivered\n", s_case, TEST_RESTART_MSGS);
+	#if MW_SUPPORT_DUPLICATE_DETECTION
+	//the new instance may repeat a seq of the old one; let the receivers forget those before the next case
+	Meshwork::Time::delay(NetworkV1::TIMEOUT_RECENT_FRAME);
+	#endif
+	return true;
+}
+
+int main(int argc, char** argv) {
+	uint16_t count = 200;
+	float loss = 0.05f;
+	s_seed = 1;
+	int opt;
+	while ( (opt = getopt(argc, argv, "n:l:s:")) != -1 ) {
+		switch ( opt ) {
+			case 'n': count = atoi(optarg); break;
+			case 'l': loss = atof(optarg); break;
+			case 's': s_seed = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "Usage: %s [-n messages] [-l loss] [-s seed]\n", argv[0]);
+				return 1;
+		}
+	}
+	if ( count == 0 || count > TEST_MSG_MAX ) {
+		fprintf(stderr, "Invalid arguments: 1 <= messages <= %d\n", TEST_MSG_MAX);
+		return 1;
+	}
+
+	medium.set_seed(s_seed);
+	medium.set_scheduler(&scheduler);
+	scheduler.begin();
+	for ( uint8_t i = 0; i < TEST_NODES; i ++ ) {
+		nodes[i].rf = new SimRadioDriver(&medium, TEST_NETWORK_ID, TEST_FIRST_NODE + i);
+		nodes[i].nwk = new NetworkV1(nodes[i].rf, NULL);
+		nodes[i].nwk->begin();
+		if ( i > 0 )
+			scheduler.spawn(receiver, &nodes[i]);
+	}
+	raw = new SimRadioDriver(&medium, TEST_NETWORK_ID, TEST_RAW_NODE);
+	raw->begin();
+
+	bool result = true;
+	for ( uint8_t hops = 1; hops <= TEST_HOPS_MAX && result; hops ++ )
+		result = test_flood(hops, count, loss);
+#if MW_SUPPORT_DUPLICATE_DETECTION
+	result = result && test_duplicate();
+#endif
+#if MW_SUPPORT_ACK_REPLAY
+	result = result && test_ack_replay();
+#endif
+#if MW_SUPPORT_RECV_QUEUE
+	result = result && test_recv_queue();
+#endif
+#if MW_SUPPORT_FRAGMENTATION
+	result = result && test_fragmentation(Network::DELIVERY_DIRECT, 0, "fragmented DIRECT", loss);
+	result = result && test_fragmentation(Network::DELIVERY_FLOOD, 2, "fragmented FLOOD over 2 hops", loss);
+#endif
+#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+	result = result && test_discovery_replies(false);
+	#if MW_SUPPORT_ASYNC_SEND
+	result = result && test_discovery_replies(true);
+	#endif
+#endif
+#if MW_SUPPORT_ROUTE_ERROR
+	result = result && test_route_error(0);
+	#if MW_SUPPORT_HOP_RELIABLE
+	result = result && test_route_error(NetworkV1::TIMEOUT_RELAY_RETRY);
+	#endif
+#endif
+#if MW_SUPPORT_ROUTE_REPAIR
+	result = result && test_route_repair(0);
+	#if MW_SUPPORT_HOP_RELIABLE
+	result = result && test_route_repair(NetworkV1::TIMEOUT_RELAY_RETRY);
+	#endif
+#endif
+	result = result && test_restart();
+#if MW_SUPPORT_ASYNC_SEND
+	result = result && test_async(count, loss);
+	result = result && test_inflight(loss);
+#endif
+	scheduler.end();
+	printf("[Test_NetworkV1] %d messages, link loss %.2f, seed %u: %s\n", count, loss, s_seed, result ? "PASSED" : "FAILED");
+	return result ? 0 : 1;
+}
@@ -0,0 +1,417 @@
+/**
+ * This file is part of the Meshwork project.
+ *
+ * Copyright (C) 2013, Sinisha Djukic
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Host test for RouteCache and CachingRouteProvider. Applies random
+ * sequences of add_route_entry, remove_*, update_QoS, route_found and
+ * route_failed to the cache and to a plain reference model of the
+ * table, and compares all observable state after every operation:
+ * route counts, route entries in index order, the three QoS
+ * calculations and the listener notifications (mirrored the way
+ * RouteCachePersistent stores them).
+ *
+ * Usage: Test_RouteCache [-n operations] [-s seed]
+ * Exits with 0 if all checks passed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Cosa/Types.h"
+#include "Meshwork/L3/Network.h"
+#include "Meshwork/L3/NetworkV1/NetworkV1.h"
+#include "Meshwork/L3/NetworkV1/RouteCache.h"
+#include "Meshwork/L3/NetworkV1/CachingRouteProvider.h"
+
+using Meshwork::L3::Network;
+using Meshwork::L3::NetworkV1::NetworkV1;
+using Meshwork::L3::NetworkV1::RouteCache;
+using Meshwork::L3::NetworkV1::CachingRouteProvider;
+
+#define TEST_SRC			1
+//more candidate routes per destination than entries
+#define TEST_ROUTE_COUNT	(RouteCache::MAX_DST_ROUTES + 3)
+
+//more destinations than lists to exercise eviction, incl. IDs above 127
+static const uint8_t DSTS[] = { 2, 50, 127, 128, 200, 254 };
+static const uint8_t TEST_DST_COUNT = sizeof(DSTS);
+
+struct test_route_t {
+	NetworkV1::route_t route;
+	uint8_t hops[NetworkV1::MAX_ROUTING_HOPS];
+};
+
+static test_route_t s_routes[TEST_DST_COUNT][TEST_ROUTE_COUNT];
+
+static uint32_t s_random;
+
+static uint32_t random32() {
+	uint32_t x = s_random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return s_random = x;
+}
+
+static uint32_t random(uint32_t n) {
+	return random32() % n;
+}
+
+///////////// Reference model /////////////
+struct model_entry_t {
+	bool used;
+	test_route_t* route;
+	int8_t qos;
+};
+
+struct model_list_t {
+	uint8_t dst;
+	model_entry_t entries[RouteCache::MAX_DST_ROUTES];
+};
+
+static model_list_t s_model[RouteCache::MAX_DST_NODES];
+
+static bool same_route(NetworkV1::route_t* a, NetworkV1::route_t* b) {
+	return a->dst == b->dst && a->hopCount == b->hopCount &&
+			memcmp(a->hops, b->hops, a->hopCount) == 0;
+}
+
+static model_list_t* model_list(uint8_t dst) {
+	for ( uint8_t i = 0; i < RouteCache::MAX_DST_NODES; i ++ )
+		if ( dst != 0 && s_model[i].dst == dst )
+			return &s_model[i];
+	return NULL;
+}
+
+static model_entry_t* model_entry(NetworkV1::route_t* route) {
+	model_list_t* list = model_list(route->dst);
+	if ( list != NULL )
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES; i ++ )
+			if ( list->entries[i].used && same_route(&list->entries[i].route->route, route) )
+				return &list->entries[i];
+	return NULL;
+}
+
+static uint8_t model_count(uint8_t dst) {
+	model_list_t* list = model_list(dst);
+	uint8_t count = 0;
+	if ( list != NULL )
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES; i ++ )
+			count += list->entries[i].used ? 1 : 0;
+	return count;
+}
+
+static int8_t model_QoS(uint8_t dst, int8_t calculate) {
+	model_list_t* list = model_list(dst);
+	if ( list == NULL )
+		return Network::QOS_LEVEL_UNKNOWN;
+	int16_t best = Network::QOS_LEVEL_MIN, worst = Network::QOS_LEVEL_MAX, sum = 0, count = 0;
+	for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES; i ++ )
+		if ( list->entries[i].used ) {
+			int8_t qos = list->entries[i].qos;
+			best = qos > best ? qos : best;
+			worst = qos < worst ? qos : worst;
+			sum += qos;
+			count ++;
+		}
+	switch ( calculate ) {
+		case Network::QOS_CALCULATE_BEST: return best;
+		case Network::QOS_CALCULATE_WORST: return worst;
+	}
+	return count == 0 ? 0 : sum / count;
+}
+
+static void model_remove_all_for_dst(uint8_t dst) {
+	model_list_t* list = model_list(dst);
+	if ( list != NULL )
+		memset(list, 0, sizeof(*list));
+}
+
+static void model_remove_entry(model_list_t* list, model_entry_t* entry) {
+	entry->used = false;
+	if ( model_count(list->dst) == 0 )
+		list->dst = 0;
+}
+
+static bool model_add(test_route_t* route, bool forceReplace) {
+	if ( model_entry(&route->route) != NULL )
+		return false;
+	uint8_t dst = route->route.dst;
+	model_entry_t* entry = NULL;
+	model_list_t* list = model_list(dst);
+	if ( list != NULL ) {
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES && entry == NULL; i ++ )
+			if ( !list->entries[i].used )
+				entry = &list->entries[i];
+		//worst QoS, the last of equals
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES && entry == NULL && forceReplace; i ++ ) {
+			bool worst = true;
+			for ( uint8_t j = i + 1; j < RouteCache::MAX_DST_ROUTES; j ++ )
+				worst &= list->entries[j].qos > list->entries[i].qos;
+			for ( uint8_t j = 0; j < i; j ++ )
+				worst &= list->entries[j].qos >= list->entries[i].qos;
+			if ( worst )
+				entry = &list->entries[i];
+		}
+	} else {
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_NODES && list == NULL; i ++ )
+			if ( s_model[i].dst == 0 )
+				list = &s_model[i];
+		//worst average QoS, the last of equals
+		for ( uint8_t i = 0; i < RouteCache::MAX_DST_NODES && list == NULL && forceReplace; i ++ ) {
+			bool worst = true;
+			int8_t qos = model_QoS(s_model[i].dst, Network::QOS_CALCULATE_AVERAGE);
+			for ( uint8_t j = i + 1; j < RouteCache::MAX_DST_NODES; j ++ )
+				worst &= model_QoS(s_model[j].dst, Network::QOS_CALCULATE_AVERAGE) > qos;
+			for ( uint8_t j = 0; j < i; j ++ )
+				worst &= model_QoS(s_model[j].dst, Network::QOS_CALCULATE_AVERAGE) >= qos;
+			if ( worst )
+				list = &s_model[i];
+		}
+		if ( list != NULL ) {
+			memset(list, 0, sizeof(*list));
+			list->dst = dst;
+			entry = &list->entries[0];
+		}
+	}
+	if ( entry == NULL )
+		return false;
+	entry->used = true;
+	entry->route = route;
+	entry->qos = Network::QOS_LEVEL_AVERAGE;
+	return true;
+}
+
+static bool model_update_QoS(NetworkV1::route_t* route, bool increase) {
+	model_entry_t* entry = model_entry(route);
+	if ( entry != NULL ) {
+		int16_t qos = entry->qos + (increase ? 1 : -1);
+		entry->qos = qos < Network::QOS_LEVEL_MIN ? Network::QOS_LEVEL_MIN :
+						(qos > Network::QOS_LEVEL_MAX ? Network::QOS_LEVEL_MAX : qos);
+	}
+	return entry != NULL;
+}
+
+///////////// Persisted mirror /////////////
+//Keeps what a persistent listener would have stored per slot
+class MirrorListener: public RouteCache::RouteCacheListener {
+public:
+	struct slot_t {
+		bool used;
+		uint8_t src, dst, hopCount;
+		uint8_t hops[NetworkV1::MAX_ROUTING_HOPS];
+	};
+	slot_t m_slots[RouteCache::MAX_DST_NODES][RouteCache::MAX_DST_ROUTES];
+
+	MirrorListener() {
+		memset(m_slots, 0, sizeof(m_slots));
+	}
+
+	void route_entry_change(RouteCache* route_cache, RouteCache::route_entry_t* entry, const uint8_t change) {
+		uint8_t node_index, route_index;
+		if ( !route_cache->get_route_entry_index(entry, node_index, route_index) )
+			return;
+		slot_t* slot = &m_slots[node_index][route_index];
+		if ( change == ROUTE_ENTRY_REMOVING ) {
+			slot->used = false;
+		} else if ( change == ROUTE_ENTRY_CHANGED ) {
+			slot->used = true;
+			slot->src = entry->route.src;
+			slot->dst = entry->route.dst;
+			slot->hopCount = entry->route.hopCount;
+			memcpy(slot->hops, entry->route.hops, entry->route.hopCount);
+		}
+	}
+};
+
+///////////// Checks /////////////
+static uint32_t s_op;
+static uint32_t s_seed;
+static bool s_failed;
+
+#define CHECK(cond, msg, ...) \
+	do { if ( !(cond) ) { \
+		printf("[Test_RouteCache] FAILED at op %u (seed %u): " msg "\n", s_op, s_seed, __VA_ARGS__); \
+		s_failed = true; \
+		return false; \
+	} } while (0)
+
+static bool check_state(RouteCache* cache, MirrorListener* mirror) {
+	static const int8_t calc[] = { Network::QOS_CALCULATE_BEST, Network::QOS_CALCULATE_WORST, Network::QOS_CALCULATE_AVERAGE };
+	for ( uint8_t d = 0; d < TEST_DST_COUNT; d ++ ) {
+		uint8_t dst = DSTS[d];
+		CHECK(cache->get_route_count(dst) == model_count(dst), "dst %d count %d, expected %d",
+				dst, cache->get_route_count(dst), model_count(dst));
+		model_list_t* list = model_list(dst);
+		uint8_t index = 0;
+		for ( uint8_t i = 0; list != NULL && i < RouteCache::MAX_DST_ROUTES; i ++ ) {
+			if ( !list->entries[i].used )
+				continue;
+			RouteCache::route_entry_t* entry = cache->get_route_entry(dst, index);
+			CHECK(entry != NULL, "dst %d index %d missing", dst, index);
+			CHECK(same_route(&entry->route, &list->entries[i].route->route) && entry->route.src == TEST_SRC,
+					"dst %d index %d route differs", dst, index);
+			CHECK(entry->qos == list->entries[i].qos, "dst %d index %d qos %d, expected %d",
+					dst, index, entry->qos, list->entries[i].qos);
+			CHECK(cache->get_route_entry(&entry->route) == entry, "dst %d index %d lookup by route", dst, index);
+			uint8_t node_index, route_index;
+			CHECK(cache->get_route_entry_index(entry, node_index, route_index), "dst %d index %d no slot", dst, index);
+			MirrorListener::slot_t* slot = &mirror->m_slots[node_index][route_index];
+			CHECK(slot->used && slot->dst == dst && slot->src == TEST_SRC && slot->hopCount == entry->route.hopCount &&
+					memcmp(slot->hops, entry->route.hops, slot->hopCount) == 0,
+					"dst %d index %d not persisted", dst, index);
+			index ++;
+		}
+		CHECK(cache->get_route_entry(dst, index) == NULL, "dst %d unexpected entry at %d", dst, index);
+		for ( uint8_t c = 0; c < sizeof(calc); c ++ )
+			CHECK(cache->get_QoS(dst, calc[c]) == model_QoS(dst, calc[c]), "dst %d QoS(%d) %d, expected %d",
+					dst, calc[c], cache->get_QoS(dst, calc[c]), model_QoS(dst, calc[c]));
+	}
+	//nothing persisted beyond the cached routes
+	uint8_t persisted = 0, cached = 0;
+	for ( uint8_t i = 0; i < RouteCache::MAX_DST_NODES; i ++ )
+		for ( uint8_t j = 0; j < RouteCache::MAX_DST_ROUTES; j ++ )
+			persisted += mirror->m_slots[i][j].used ? 1 : 0;
+	for ( uint8_t d = 0; d < TEST_DST_COUNT; d ++ )
+		cached += model_count(DSTS[d]);
+	CHECK(persisted == cached, "%d routes persisted, %d cached", persisted, cached);
+	return true;
+}
+
+static void setup_routes() {
+	for ( uint8_t d = 0; d < TEST_DST_COUNT; d ++ )
+		for ( uint8_t r = 0; r < TEST_ROUTE_COUNT; r ++ ) {
+			test_route_t* t = &s_routes[d][r];
+			t->route.src = TEST_SRC;
+			t->route.dst = DSTS[d];
+			t->route.hops = t->hops;
+			//unique per destination: hop count and first hop differ
+			t->route.hopCount = r % (NetworkV1::MAX_ROUTING_HOPS + 1);
+			for ( uint8_t k = 0; k < NetworkV1::MAX_ROUTING_HOPS; k ++ )
+				t->hops[k] = 10 + r + k * 16;
+		}
+}
+
+static test_route_t* pick_route() {
+	return &s_routes[random(TEST_DST_COUNT)][random(TEST_ROUTE_COUNT)];
+}
+
+static bool run(uint32_t operations) {
+	MirrorListener mirror;
+	RouteCache cache(&mirror);
+	CachingRouteProvider provider(&cache, 0);
+	memset(s_model, 0, sizeof(s_model));
+	setup_routes();
+
+	for ( s_op = 0; s_op < operations; s_op ++ ) {
+		test_route_t* route = pick_route();
+		switch ( random(16) ) {
+			case 0: case 1: case 2: {
+				bool force = random(2);
+				RouteCache::route_entry_t* entry = cache.add_route_entry(&route->route, force);
+				bool added = model_add(route, force);
+				CHECK((entry != NULL) == added, "add_route_entry force=%d returned %s", force, entry != NULL ? "entry" : "NULL");
+				break;
+			}
+			case 3: {
+				uint8_t dst = route->route.dst;
+				uint8_t count = model_count(dst);
+				if ( count > 0 ) {
+					uint8_t index = random(count);
+					cache.remove_route_entry(cache.get_route_entry(dst, index));
+					model_list_t* list = model_list(dst);
+					for ( uint8_t i = 0; i < RouteCache::MAX_DST_ROUTES; i ++ )
+						if ( list->entries[i].used && index-- == 0 ) {
+							model_remove_entry(list, &list->entries[i]);
+							break;
+						}
+				}
+				break;
+			}
+			case 4:
+				cache.remove_all_for_dst(route->route.dst);
+				model_remove_all_for_dst(route->route.dst);
+				break;
+			case 5:
+				if ( random(8) == 0 ) {
+					cache.remove_all();
+					memset(s_model, 0, sizeof(s_model));
+				}
+				break;
+			case 6: case 7: {
+				bool increase = random(2);
+				bool updated = cache.update_QoS(&route->route, increase);
+				CHECK(updated == model_update_QoS(&route->route, increase), "update_QoS returned %d", updated);
+				break;
+			}
+			case 8: case 9: case 10: {
+				//route_found: better QoS or add, depending on the policy
+				provider.set_update_policy(random(4));
+				provider.set_route_update_enabled(random(4) != 0);
+				provider.route_found(&route->route);
+				if ( !model_update_QoS(&route->route, true) && provider.get_route_update_enabled() )
+					model_add(route, provider.get_update_policy() & CachingRouteProvider::UPDATE_REPLACE_ON_QOS_WORST);
+				break;
+			}
+			default: {
+				//route_failed, in bursts so that QoS reaches the minimum
+				provider.set_update_policy(random(4));
+				provider.set_route_update_enabled(random(4) != 0);
+				uint8_t burst = random(4) == 0 ? random(2 * Network::QOS_LEVEL_MAX + 10) : 1;
+				for ( uint8_t i = 0; i < burst; i ++ ) {
+					provider.route_failed(&route->route);
+					model_entry_t* entry = model_entry(&route->route);
+					if ( model_update_QoS(&route->route, false) && provider.get_route_update_enabled() &&
+							(provider.get_update_policy() & CachingRouteProvider::UPDATE_REMOVE_ON_QOS_MIN) &&
+								entry->qos == Network::QOS_LEVEL_MIN )
+						model_remove_entry(model_list(route->route.dst), entry);
+				}
+				break;
+			}
+		}
+		CHECK(provider.get_routeCount(route->route.dst) == model_count(route->route.dst), "provider count for dst %d",
+				route->route.dst);
+		if ( !check_state(&cache, &mirror) )
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	uint32_t operations = 200000;
+	s_seed = 1;
+	int opt;
+	while ( (opt = getopt(argc, argv, "n:s:")) != -1 ) {
+		switch ( opt ) {
+			case 'n': operations = strtoul(optarg, NULL, 0); break;
+			case 's': s_seed = strtoul(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "Usage: %s [-n operations] [-s seed]\n", argv[0]);
+				return 1;
+		}
+	}
+	s_random = s_seed == 0 ? 0x9E3779B9 : s_seed;
+	bool result = run(operations);
+	printf("[Test_RouteCache] %u operations, seed %u: %s\n", operations, s_seed, result ? "PASSED" : "FAILED");
+	return result ? 0 : 1;
+}
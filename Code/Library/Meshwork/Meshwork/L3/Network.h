@@ -141,12 +141,16 @@ namespace Meshwork {
 		static const int8_t ERROR_NO_KNOWN_ROUTES = -40;
 		/** Rerouting a message has failed. */
 		static const int8_t ERROR_REROUTE_FAILED = -41;
+		/** A relay has reported a broken link on the route. */
+		static const int8_t ERROR_ROUTE_BROKEN = -42;
 
 		//Send errors code group
 		/** Driver send has failed. */
 		static const int8_t ERROR_DRIVER_SEND_FAILED = -51;
 		/** Send aborted by the app. */
 		static const int8_t ERROR_DRIVER_SEND_ABORTED = -52;
+		/** No free slot for another asynchronous send. */
+		static const int8_t ERROR_SEND_QUEUE_FULL = -53;
 		
 		/** Last error code from the L3 range. */
 		static const int8_t ERROR_END_L3 = -63;
@@ -298,7 +302,7 @@ namespace Meshwork {
 			virtual msg_l3_status_t send(uint8_t delivery, uint8_t retry,
 								uint8_t dest, uint8_t port,
 								const void* buf, size_t len,
-								void* bufACK, size_t& lenACK);
+								void* bufACK, size_t& lenACK) = 0;
 
 			//convenience send method
 			msg_l3_status_t send(uint8_t dest, uint8_t port,
@@ -315,7 +319,7 @@ namespace Meshwork {
 
 			//main recv method
 			virtual msg_l3_status_t recv(uint8_t& src, uint8_t& port, void* data, size_t& dataLenMax,
-					uint32_t ms, Meshwork::L3::Network::ACKProvider* ackProvider);
+					uint32_t ms, Meshwork::L3::Network::ACKProvider* ackProvider) = 0;
 		
 		};//end of Meshwork::L3::Network
 		
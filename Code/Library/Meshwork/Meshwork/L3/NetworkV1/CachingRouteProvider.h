@@ -44,8 +44,11 @@ namespace Meshwork {
 				RouteCache* m_route_cache;
 				uint8_t m_update_policy;
 				bool m_route_update_enabled;
+				uint8_t m_address;
 
 			public:
+				/** QoS of a route learned from others' traffic; the first to go when a found route needs the slot. */
+				static const int8_t QOS_LEVEL_LEARNED = (Network::QOS_LEVEL_AVERAGE + Network::QOS_LEVEL_MIN) / 2;
 
 				//removes the route when messages to the destination consistently fail
 				static const uint8_t UPDATE_REMOVE_ON_QOS_MIN 		= 0x1;
@@ -55,13 +58,13 @@ namespace Meshwork {
 				CachingRouteProvider(RouteCache* cache, uint8_t update_policy):
 					m_route_cache(cache),
 					m_update_policy(update_policy),
-					m_route_update_enabled(true)
+					m_route_update_enabled(true),
+					m_address(0)
 				{
 				};
 
 				  void set_address(uint8_t src) {
-					UNUSED(src);
-					//nothing to do currently
+					m_address = src;
 				  }
 				  
 				  uint8_t get_routeCount(uint8_t dst) {
@@ -90,6 +93,9 @@ namespace Meshwork {
 				  }
 				  
 				  void route_found(NetworkV1::route_t* route) {
+					//routes that ended here are reported too, but we never send to ourselves
+					if ( route->dst == m_address )
+						return;
 					if ( !m_route_cache->update_QoS(route, true) &&
 							m_route_update_enabled ) {
 						m_route_cache->add_route_entry(route, ( m_update_policy & UPDATE_REPLACE_ON_QOS_WORST ));
@@ -106,6 +112,22 @@ namespace Meshwork {
 					}
 				  }
 
+				  void link_failed(uint8_t from, uint8_t to) {
+					if ( m_route_update_enabled )
+						m_route_cache->fail_routes_with_link(from, to);
+				  }
+
+				  int8_t get_route_QoS(uint8_t dst, uint8_t index) {
+					RouteCache::route_entry_t* entry = m_route_cache->get_route_entry(dst, index);
+					return entry != NULL ? entry->qos : Network::QOS_LEVEL_UNKNOWN;
+				  }
+
+				  void route_learned(NetworkV1::route_t* route) {
+					//only into free slots; known routes keep their QoS until used
+					if ( m_route_update_enabled && m_route_cache->get_route_entry(route) == NULL )
+						m_route_cache->add_route_entry(route, false, QOS_LEVEL_LEARNED);
+				  }
+
 			};
 		};
 	};
@@ -306,6 +306,8 @@ uint8_t Meshwork::L3::NetworkV1::NetworkSerial::processRFStartRecv(SerialMessage
 		//not needed here:
 		//m_currentMsg = msg;
 
+		//recv() sets the length of the message received; the whole buffer is available again
+		m_lastMsgLen = sizeof(m_lastMsgData);
 		int res = m_network->recv(m_lastMsgSrc, m_lastMsgPort, &m_lastMsgData, m_lastMsgLen, timeout, this);
 
 		MW_LOG_INFO(MW_LOG_NETWORKSERIAL, "Receive done. SerResult=%d, Src=%d, Port=%d", res, m_lastMsgSrc, m_lastMsgPort);
@@ -108,8 +108,8 @@ namespace Meshwork {
 				uint8_t m_lastSerialMsgLen;
 				uint8_t m_lastMsgSrc;
 				uint8_t m_lastMsgPort;
-				uint8_t m_lastMsgData[NetworkV1::PAYLOAD_MAX];
-				uint16_t m_lastMsgLen;
+				uint8_t m_lastMsgData[NetworkV1::RECV_PAYLOAD_MAX];
+				size_t m_lastMsgLen;
 				uint8_t m_lastAckData[NetworkV1::ACK_PAYLOAD_MAX];
 				SerialMessageAdapter::serialmsg_t* m_currentMsg;
 		
@@ -129,7 +129,7 @@ namespace Meshwork {
 					m_network(network),
 					m_adapter(adapter),
 					m_lastSerialMsgLen(0),
-					m_lastMsgLen(NetworkV1::PAYLOAD_MAX)
+					m_lastMsgLen(NetworkV1::RECV_PAYLOAD_MAX)
 				{
 					m_networkKey[0] = 0;
 					//TODO Pull into Network class API
@@ -34,16 +34,516 @@
 
 using Meshwork::L3::Network;
 
+#if MW_SUPPORT_DUPLICATE_DETECTION
+bool Meshwork::L3::NetworkV1::NetworkV1::isDuplicate(uint8_t origin, uint8_t port, uint8_t seq, bool flood) {
+	uint32_t now = RTC::millis();
+	for ( int i = 0; i < MAX_RECENT_FRAMES; i ++ ) {
+		recent_frame_t* frame = &m_recentFrames[i];
+		if ( frame->origin == origin && frame->port == port && frame->seq == seq && frame->flood == flood ) {
+			m_recentFrame = frame;
+			if ( !Meshwork::Time::passed(now - frame->time, flood ? TIMEOUT_RECENT_FLOOD : TIMEOUT_RECENT_FRAME) ) {
+				MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Duplicate: origin=%d, port=%d, seq=%d", origin, port, seq);
+				return true;
+			}
+			//expired; a FLOOD retry keeps its cached ACK for as long as a regular frame would
+	#if MW_SUPPORT_ACK_REPLAY
+			if ( Meshwork::Time::passed(now - frame->time, TIMEOUT_RECENT_FRAME) )
+				frame->ackLen = ACK_NOT_CACHED;
+	#endif
+			frame->time = now;
+			return false;
+		}
+	}
+	//not seen, replace the oldest
+	recent_frame_t* frame = &m_recentFrames[m_recentFramesNext];
+	frame->origin = origin;
+	frame->port = port;
+	frame->seq = seq;
+	frame->flood = flood;
+	frame->time = now;
+	#if MW_SUPPORT_ACK_REPLAY
+	frame->ackLen = ACK_NOT_CACHED;
+	#endif
+	m_recentFrame = frame;
+	m_recentFramesNext = (m_recentFramesNext + 1) % MAX_RECENT_FRAMES;
+	return false;
+}
+#endif
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::getACKPayload(Meshwork::L3::Network::ACKProvider* ackProvider,
+						uint8_t origin, uint8_t hopPort, void* data, uint8_t dataLen, void* bufACK) {
+#if MW_SUPPORT_ACK_REPLAY
+	recent_frame_t* frame = m_recentFrame;
+	if ( frame != NULL && frame->ackLen != ACK_NOT_CACHED ) {
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Replay cached ACK payload, size: %d", frame->ackLen);
+		memcpy(bufACK, frame->ack, frame->ackLen);
+		return frame->ackLen;
+	}
+#endif
+	uint8_t bufACKsize = 0;
+	if (ackProvider != NULL) {
+		bufACKsize = ackProvider->returnACKPayload(origin, hopPort, data, dataLen, bufACK, ACK_PAYLOAD_MAX);
+	}
+#if MW_SUPPORT_ACK_REPLAY
+	if ( frame != NULL && bufACKsize <= ACK_PAYLOAD_MAX ) {
+		memcpy(frame->ack, bufACK, bufACKsize);
+		frame->ackLen = bufACKsize;
+	}
+#endif
+	return bufACKsize;
+}
+
+#if MW_SUPPORT_RANDOM_BACKOFF
+uint32_t Meshwork::L3::NetworkV1::NetworkV1::nextRandom() {
+	//xorshift32, seeded per node in begin()
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
+#endif
+
+uint16_t Meshwork::L3::NetworkV1::NetworkV1::getBackoff(uint8_t retry) {
+#if MW_SUPPORT_RANDOM_BACKOFF
+	//window doubles with each retry up to the cap; jitter percent of it is random
+	uint32_t window = m_backoffBase;
+	for ( uint8_t i = 0; i < retry && window < m_backoffMax; i ++ )
+		window <<= 1;
+	if ( window > m_backoffMax )
+		window = m_backoffMax;
+	uint32_t jitter = window * m_backoffJitter / 100;
+	uint32_t wait = window - jitter;
+	if ( jitter > 0 )
+		wait += nextRandom() % (jitter + 1);
+	return (uint16_t) wait;
+#else
+	UNUSED(retry);
+	return RETRY_WAIT_DIRECT;
+#endif
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::set_backoff(uint16_t base, uint16_t max, uint8_t jitter) {
+#if MW_SUPPORT_RANDOM_BACKOFF
+	m_backoffBase = base;
+	m_backoffMax = max < base ? base : max;
+	m_backoffJitter = jitter > 100 ? 100 : jitter;
+#else
+	UNUSED(base);
+	UNUSED(max);
+	UNUSED(jitter);
+#endif
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::getRTTKey(univmsg_t* msg, uint8_t dest, uint8_t& dst, uint8_t& hopCount) {
+	if ( msg->nwk_ctrl.delivery & DELIVERY_DIRECT ) {
+		dst = dest;
+		hopCount = 0;
+		return dest != Wireless::Driver::BROADCAST;
+	}
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( msg->nwk_ctrl.delivery & DELIVERY_ROUTED ) {
+		dst = msg->msg_routed.route_info.route.dst;
+		hopCount = msg->msg_routed.route_info.route.hopCount;
+		return hopCount <= MAX_ROUTING_HOPS;
+	}
+	#if MW_SUPPORT_DELIVERY_FLOOD && MW_SUPPORT_ADAPTIVE_TIMEOUT
+	//FLOOD discovery takes an unknown number of hops, so it is kept apart from the routes
+	if ( msg->nwk_ctrl.delivery & DELIVERY_FLOOD ) {
+		dst = msg->msg_flood.flood_info.route.dst;
+		hopCount = RTT_HOPS_FLOOD;
+		return dst != Wireless::Driver::BROADCAST;
+	}
+	#endif
+#endif
+	return false;
+}
+
+uint32_t Meshwork::L3::NetworkV1::NetworkV1::getACKTimeout(univmsg_t* msg, uint8_t dest, uint32_t upper) {
+	uint8_t dst, hopCount;
+	if ( !getRTTKey(msg, dest, dst, hopCount) )
+		return upper;
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+	rtt_estimate_t* est = &m_rttHops[hopCount];
+	for ( int i = 0; i < MAX_RTT_NODES; i ++ )
+		if ( m_rttNodes[i].dst == dst && m_rttNodes[i].hopCount == hopCount && m_rttNodes[i].rtt.srtt != 0 ) {
+			est = &m_rttNodes[i].rtt;
+			break;
+		}
+	uint32_t timeout;
+	if ( est->srtt != 0 ) {
+		//RFC 6298: RTO = SRTT + 4 * RTTVAR
+		timeout = (uint32_t) est->srtt + 4 * (uint32_t) est->rttvar;
+		if ( timeout < TIMEOUT_ACK_MIN )
+			timeout = TIMEOUT_ACK_MIN;
+	#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+		//the relays take a FLOOD retry sent sooner for a copy of the first attempt and drop it
+		if ( hopCount == RTT_HOPS_FLOOD && timeout < TIMEOUT_ACK_DIRECT )
+			timeout = TIMEOUT_ACK_DIRECT;
+	#endif
+	} else {
+		//no samples yet; a route takes about one DIRECT timeout per link
+		timeout = (uint32_t) TIMEOUT_ACK_DIRECT * (hopCount + 1);
+	}
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "ACK timeout for %d/%d: %l", dst, hopCount, timeout);
+	return timeout < upper ? timeout : upper;
+#else
+	return upper;
+#endif
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::updateRTT(univmsg_t* msg, uint8_t dest, uint32_t rtt) {
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+	uint8_t dst, hopCount;
+	if ( !getRTTKey(msg, dest, dst, hopCount) )
+		return;
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "RTT sample for %d/%d: %l", dst, hopCount, rtt);
+	rtt_node_t* node = NULL;
+	for ( int i = 0; i < MAX_RTT_NODES && node == NULL; i ++ )
+		if ( m_rttNodes[i].dst == dst && m_rttNodes[i].hopCount == hopCount )
+			node = &m_rttNodes[i];
+	if ( node == NULL ) {//replace the oldest
+		node = &m_rttNodes[m_rttNodesNext];
+		m_rttNodesNext = (m_rttNodesNext + 1) % MAX_RTT_NODES;
+		node->dst = dst;
+		node->hopCount = hopCount;
+		node->rtt.srtt = 0;
+	}
+	updateRTTEstimate(&node->rtt, rtt);
+	updateRTTEstimate(&m_rttHops[hopCount], rtt);
+#else
+	UNUSED(msg);
+	UNUSED(dest);
+	UNUSED(rtt);
+#endif
+}
+
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+void Meshwork::L3::NetworkV1::NetworkV1::updateRTTEstimate(rtt_estimate_t* est, uint32_t rtt) {
+	uint16_t r = rtt == 0 ? 1 : (rtt > 0xFFFF ? 0xFFFF : (uint16_t) rtt);
+	if ( est->srtt == 0 ) {
+		est->srtt = r;
+		est->rttvar = r / 2;
+	} else {
+		//alpha = 1/8, beta = 1/4
+		uint16_t delta = est->srtt > r ? est->srtt - r : r - est->srtt;
+		est->rttvar = (uint16_t) ((3 * (uint32_t) est->rttvar + delta) / 4);
+		est->srtt = (uint16_t) ((7 * (uint32_t) est->srtt + r) / 8);
+		if ( est->srtt == 0 )
+			est->srtt = 1;
+	}
+}
+#endif
+
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+Meshwork::L3::NetworkV1::NetworkV1::last_route_t* Meshwork::L3::NetworkV1::NetworkV1::getLastRoute(uint8_t dst) {
+	for ( int i = 0; i < MAX_LAST_ROUTES; i ++ )
+		if ( m_lastRoutes[i].dst == dst )
+			return &m_lastRoutes[i];
+	return NULL;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::setLastRoute(uint8_t dst, route_t* route) {
+	#if MW_SUPPORT_ROUTE_REPAIR
+	//the ACK came over another route, which routeRepaired() has kept already
+	if ( m_routeRepaired ) {
+		m_routeRepaired = false;
+		return;
+	}
+	#endif
+	last_route_t* last = getLastRoute(dst);
+	if ( last == NULL ) {//replace the oldest
+		last = &m_lastRoutes[m_lastRoutesNext];
+		m_lastRoutesNext = (m_lastRoutesNext + 1) % MAX_LAST_ROUTES;
+		last->dst = dst;
+	}
+	if ( route == NULL ) {
+		last->delivery = DELIVERY_DIRECT;
+		last->hopCount = 0;
+	} else {
+		last->delivery = DELIVERY_ROUTED;
+		last->hopCount = route->hopCount;
+		memcpy(last->hops, route->hops, route->hopCount);
+	}
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Last working route to %d: deliv=%d, hops=%d", dst, last->delivery, last->hopCount);
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::clearLastRoute(uint8_t dst) {
+	last_route_t* last = getLastRoute(dst);
+	if ( last != NULL )
+		last->dst = 0;
+}
+#endif
+
+#if MW_SUPPORT_DELIVERY_PREDICTION
+Meshwork::L3::NetworkV1::NetworkV1::delivery_stats_t* Meshwork::L3::NetworkV1::NetworkV1::getDeliveryStats(uint8_t dst, bool create) {
+	for ( int i = 0; i < MAX_DELIVERY_STATS; i ++ )
+		if ( m_deliveryStats[i].dst == dst )
+			return &m_deliveryStats[i];
+	if ( !create )
+		return NULL;
+	//replace the oldest
+	delivery_stats_t* stats = &m_deliveryStats[m_deliveryStatsNext];
+	m_deliveryStatsNext = (m_deliveryStatsNext + 1) % MAX_DELIVERY_STATS;
+	memset(stats, 0, sizeof(delivery_stats_t));
+	stats->dst = dst;
+	return stats;
+}
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::predictDelivery(uint8_t dst, uint8_t delivery) {
+	delivery_stats_t* stats = getDeliveryStats(dst, false);
+	if ( stats == NULL )
+		return delivery;
+	uint8_t skip = 0;
+	if ( stats->directFails >= PREDICT_FAIL_STREAK )
+		skip |= DELIVERY_DIRECT;
+	#if MW_SUPPORT_DELIVERY_FLOOD
+	//a FLOOD finds the routes anew, so the stale ones are not worth the wait
+	if ( stats->routedFails >= PREDICT_FAIL_STREAK )
+		skip |= DELIVERY_ROUTED;
+	#endif
+	//never skip the last method left
+	if ( (delivery & skip) == 0 || (delivery & ~skip) == 0 )
+		return delivery;
+	if ( ++ stats->skipped >= PREDICT_PROBE_INTERVAL ) {
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Probing skipped delivery to %d: %d", dst, skip);
+		stats->skipped = 0;
+		return delivery;
+	}
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Skipping delivery to %d: %d", dst, skip);
+	return delivery & ~skip;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::updateDeliveryStats(uint8_t dst, uint8_t delivery, bool ok) {
+	//successes only matter for destinations that have failed before
+	delivery_stats_t* stats = getDeliveryStats(dst, !ok);
+	if ( stats == NULL )
+		return;
+	uint8_t* fails = delivery == DELIVERY_DIRECT ? &stats->directFails : &stats->routedFails;
+	if ( ok )
+		*fails = 0;
+	else if ( *fails < 0xFF )
+		(*fails) ++;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::heardDirect(uint8_t src) {
+	delivery_stats_t* stats = getDeliveryStats(src, false);
+	if ( stats != NULL )
+		stats->directFails = 0;
+}
+#endif
+
+#if MW_SUPPORT_ETX_ROUTING
+uint16_t Meshwork::L3::NetworkV1::NetworkV1::getLinkETX(uint8_t neighbour) {
+	#if MW_SUPPORT_NEIGHBOUR_TABLE
+	neighbour_t* n = getNeighbour(neighbour, false);
+	if ( n != NULL && n->sent + n->failed > 0 ) {
+		//transmissions per acknowledged frame; one extra of each keeps a single loss from looking fatal
+		uint32_t attempts = (uint32_t) n->sent + n->failed + n->retransmits + 1;
+		uint32_t etx = attempts * ETX_UNIT / ((uint32_t) n->sent + 1);
+		return etx > ETX_LINK_MAX ? ETX_LINK_MAX : (uint16_t) etx;
+	}
+	#else
+	UNUSED(neighbour);
+	#endif
+	return ETX_UNIT;
+}
+
+uint16_t Meshwork::L3::NetworkV1::NetworkV1::getRouteETX(route_t* route, int8_t qos) {
+	//only our own link is measured; the relays do not report theirs, so the others count as perfect
+	//and the route's QoS stands in for their losses
+	uint16_t cost = getLinkETX(route->hopCount == 0 ? route->dst : route->hops[0]) + route->hopCount * ETX_UNIT;
+	if ( qos != Network::QOS_LEVEL_UNKNOWN && qos < Network::QOS_LEVEL_AVERAGE )
+		cost += (Network::QOS_LEVEL_AVERAGE - qos) * ETX_UNIT;
+	return cost;
+}
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::rankRoutes(uint8_t dst, uint8_t* order, uint16_t* cost) {
+	uint8_t count = m_advisor != NULL ? m_advisor->get_routeCount(dst) : 0;
+	if ( count > MAX_RANKED_ROUTES )
+		count = MAX_RANKED_ROUTES;
+	for ( int i = 0; i < count; i ++ ) {
+		route_t* route = m_advisor->get_route(dst, i);
+		uint16_t c = route == NULL || route->hopCount > m_maxHops ? 0xFFFF : getRouteETX(route, m_advisor->get_route_QoS(dst, i));
+		//insertion sort; equal costs keep the slot order
+		int j = i;
+		for ( ; j > 0 && cost[j-1] > c; j -- ) {
+			order[j] = order[j-1];
+			cost[j] = cost[j-1];
+		}
+		order[j] = i;
+		cost[j] = c;
+	}
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Ranked %d routes to %d, best ETX=%d", count, dst, count > 0 ? cost[0] : 0);
+	return count;
+}
+#endif
+
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+Meshwork::L3::NetworkV1::NetworkV1::neighbour_t* Meshwork::L3::NetworkV1::NetworkV1::getNeighbour(uint8_t address, bool create) {
+	neighbour_t* oldest = NULL;
+	for ( int i = 0; i < MAX_NEIGHBOURS; i ++ ) {
+		neighbour_t* n = &m_neighbours[i];
+		if ( n->address == address )
+			return n;
+		if ( oldest == NULL || (oldest->address != 0 &&
+				(n->address == 0 || RTC::since(n->lastHeard) > RTC::since(oldest->lastHeard))) )
+			oldest = n;
+	}
+	if ( !create || address == Wireless::Driver::BROADCAST )
+		return NULL;
+	memset(oldest, 0, sizeof(neighbour_t));
+	oldest->address = address;
+	return oldest;
+}
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::get_neighbour_count() {
+	uint8_t count = 0;
+	for ( int i = 0; i < MAX_NEIGHBOURS; i ++ )
+		if ( m_neighbours[i].address != 0 )
+			count ++;
+	return count;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::neighbourHeard(uint8_t src) {
+	neighbour_t* n = getNeighbour(src, true);
+	if ( n == NULL )
+		return;
+	n->lastHeard = RTC::millis();
+	if ( n->received == 0xFFFF ) {
+		n->received /= 2;
+		n->sent /= 2;
+		n->failed /= 2;
+		n->retransmits /= 2;
+	}
+	n->received ++;
+	if ( m_driverCaps.rssi )
+		n->rssi = (int8_t) m_driver->get_input_power_level();
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::neighbourSent(uint8_t dest, bool acked) {
+	neighbour_t* n = getNeighbour(dest, true);
+	if ( n == NULL )
+		return;
+	uint8_t retransmits = m_driverCaps.retransmits ? m_driver->get_retransmit_count() : 0;
+	if ( n->sent == 0xFFFF || n->failed == 0xFFFF || n->retransmits > 0xFFFF - retransmits ) {
+		n->received /= 2;
+		n->sent /= 2;
+		n->failed /= 2;
+		n->retransmits /= 2;
+	}
+	n->retransmits += retransmits;
+	if ( acked ) {
+		n->lastHeard = RTC::millis();
+		n->sent ++;
+	} else {
+		n->failed ++;
+	}
+}
+#endif
+
+#if MW_SUPPORT_ROUTE_LEARNING
+void Meshwork::L3::NetworkV1::NetworkV1::learnRoute(route_t* route, uint8_t myHop, bool reverse) {
+	uint8_t hopCount = reverse ? myHop - 1 : route->hopCount - myHop;
+	//neighbours are reached DIRECT
+	if ( m_advisor == NULL || hopCount == 0 || hopCount > m_maxHops )
+		return;
+	uint8_t hops[MAX_ROUTING_HOPS];
+	route_t learned;
+	learned.src = m_driver->get_device_address();
+	learned.hopCount = hopCount;
+	learned.hops = hops;
+	if ( reverse ) {
+		learned.dst = route->src;
+		for ( int i = 0; i < hopCount; i ++ )
+			hops[i] = route->hops[myHop - 2 - i];
+	} else {
+		learned.dst = route->dst;
+		memcpy(hops, route->hops + myHop, hopCount);
+	}
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Learned route to %d, hops=%d", learned.dst, hopCount);
+	m_advisor->route_learned(&learned);
+}
+#endif
+
+#if MW_SUPPORT_MULTIPATH_DISCOVERY
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::addDiscoveredRoute(discovered_route_t* routes, uint8_t count, route_t* route) {
+	uint8_t hopCount = route->hopCount;
+	for ( int i = 0; i < count; i ++ )
+		if ( routes[i].hopCount == hopCount && memcmp(routes[i].hops, route->hops, hopCount) == 0 )
+			return count;
+	//shorter first; among equals, the earlier reply first
+	uint8_t pos = count;
+	while ( pos > 0 && routes[pos-1].hopCount > hopCount )
+		pos --;
+	if ( pos == MAX_DISCOVERED_ROUTES )
+		return count;
+	if ( count < MAX_DISCOVERED_ROUTES )
+		count ++;
+	memmove(&routes[pos+1], &routes[pos], (count - 1 - pos) * sizeof(discovered_route_t));
+	routes[pos].hopCount = hopCount;
+	memcpy(routes[pos].hops, route->hops, hopCount);
+	return count;
+}
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::collectRoutes(uint8_t port, uint8_t seq, uint8_t dest, uint32_t window, discovered_route_t* routes, uint8_t count) {
+	uint32_t start = RTC::millis();
+	uint8_t data[FRAME_MAX];
+	univmsg_t reply;
+	while ( !m_sendAbort && !Meshwork::Time::passed(RTC::since(start), window) ) {
+	#if MW_SUPPORT_ASYNC_SEND
+		poll();
+	#endif
+		uint32_t elapsed = RTC::since(start);
+		uint8_t src, replyPort;
+		int result = m_driver->recv(src, replyPort, data, FRAME_MAX, elapsed < window ? window - elapsed : 1);
+		if ( result <= 0 )
+			continue;
+	#if MW_SUPPORT_NEIGHBOUR_TABLE
+		neighbourHeard(src);
+	#endif
+		get_msg(&reply, data, result);
+		route_t* route = &reply.msg_routed.route_info.route;
+		if ( replyPort == port && reply.nwk_ctrl.seq == seq && (reply.nwk_ctrl.delivery & ACK) ) {
+			//the other copies of our discovery, answered over the route each has taken
+			if ( (reply.nwk_ctrl.delivery & DELIVERY_ROUTED) && route->dst == dest &&
+					route->hopCount > 0 && route->hopCount <= m_maxHops ) {
+				MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Alternative route, hops=%d", route->hopCount);
+				count = addDiscoveredRoute(routes, count, route);
+				continue;
+			}
+			//late FLOOD ACKs of the neighbours
+			if ( reply.nwk_ctrl.delivery & DELIVERY_FLOOD )
+				continue;
+		}
+		bool handled = false;
+	#if MW_SUPPORT_ASYNC_SEND
+		handled = !m_driver->is_broadcast() && handlePendingACK(src, replyPort, &reply, result);
+	#endif
+	#if MW_SUPPORT_RECV_QUEUE
+		if ( !handled )
+			queueFrame(src, replyPort, m_driver->is_broadcast(), data, result);
+	#endif
+		UNUSED(handled);
+	}
+	return count;
+}
+#endif
+
 bool Meshwork::L3::NetworkV1::NetworkV1::sendWithoutACK(uint8_t dest, uint8_t hopPort, iovec_t* vp, uint8_t attempts) {
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send to: %d:%d", dest, hopPort);
 	int sendCode = -1;
 	for (int i = 0; i < attempts && sendCode < 0; i ++) {
-		if ((sendCode = m_driver->send(dest, hopPort, vp)) < 0) {//send back ACK
+		sendCode = m_driver->send(dest, hopPort, vp);
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+		if ( dest != Wireless::Driver::BROADCAST && sendCode != -1 )
+			neighbourSent(dest, sendCode >= 0);
+#endif
+		if ( sendCode < 0 ) {//send back ACK
 			MW_LOG_ERROR(MW_LOG_NETWORKV1, "Driver send failed: %d", sendCode);
 			if ( m_sendAbort )
 				break;
 			if ( i < attempts - 1 )//don't sleep after last send
-				Meshwork::Time::delay(RETRY_WAIT_DIRECT);
+				Meshwork::Time::delay(getBackoff(i));
 		}
 	}
 	if ( sendCode >= 0 ) {
@@ -58,12 +558,17 @@ bool Meshwork::L3::NetworkV1::NetworkV1::sendWithoutACK(uint8_t dest, uint8_t ho
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send to: %d:%d", dest, hopPort);
 	int sendCode = -1;
 	for (int i = 0; i < attempts && sendCode < 0; i ++) {
-		if ((sendCode = m_driver->send(dest, hopPort, buf, len)) < 0) {//send back ACK
+		sendCode = m_driver->send(dest, hopPort, buf, len);
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+		if ( dest != Wireless::Driver::BROADCAST && sendCode != -1 )
+			neighbourSent(dest, sendCode >= 0);
+#endif
+		if ( sendCode < 0 ) {//send back ACK
 			MW_LOG_ERROR(MW_LOG_NETWORKV1, "Driver send failed, code: %d", sendCode);
 			if ( m_sendAbort )
 				break;
 			if ( i < attempts - 1 )//don't sleep after last send
-				Meshwork::Time::delay(RETRY_WAIT_DIRECT);
+				Meshwork::Time::delay(getBackoff(i));
 		}
 	}
 	if ( sendCode >= 0 ) {
@@ -100,10 +605,29 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 	
 	MW_LOG_DEBUG_VP_BYTES(MW_LOG_NETWORKV1, PSTR("L2 DATA TO SEND: "), toSend);
 	
+#if MW_SUPPORT_ROUTE_REPAIR && MW_SUPPORT_LAST_WORKING_ROUTE
+	m_routeRepaired = false;
+#endif
+
+	//ackTimeout is the upper bound; start from the measured round trip and back off on each retry
+	uint32_t attemptTimeout = getACKTimeout(msg, dest, ackTimeout);
+	uint32_t firstSent = RTC::millis();
+	
 	for (int i = 0; i < attempts; i ++) {
 #if MW_SUPPORT_DELIVERY_FLOOD
 			bool oneFloodACK = false;
 #endif
+		if ( i > 0 && attemptTimeout < ackTimeout )
+			attemptTimeout = attemptTimeout * 2 < ackTimeout ? attemptTimeout * 2 : ackTimeout;
+#if MW_SUPPORT_RANDOM_BACKOFF
+		//don't retry in lockstep with the neighbours we may have collided with
+		if ( i > 0 ) {
+			uint16_t wait = getBackoff(i - 1);
+			Meshwork::Time::delay(wait < attemptsDelay ? wait : attemptsDelay);
+		}
+#else
+		UNUSED(attemptsDelay);
+#endif
 
 		MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(m_driver->get_device_address(), dest, port, msg);
 
@@ -120,16 +644,31 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 			int reply_result;
 			//the next recv may come with an irrelevant message/data, so recv some more until timeout is reached
 			uint32_t start = RTC::millis();
-			uint8_t dataACK[ACK_PAYLOAD_MAX];
+#if MW_SUPPORT_DELIVERY_FLOOD
+			m_lastAttempt = start;
+#endif
+			uint8_t dataACK[FRAME_MAX];
 			bool ignored = false;
 
 			MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_RECV_ACK_BEGIN();
 
 			do {
 				ignored = false;
+#if MW_SUPPORT_ASYNC_SEND
+				//keep the asynchronous sends going while we block
+				poll();
+#endif
 				
-				reply_result = m_driver->recv(reply_src, reply_port, &dataACK, ACK_PAYLOAD_MAX, TIMEOUT_ACK_RECEIVE); //no ack received
+				uint32_t elapsed = RTC::since(start);
+				uint32_t wait = elapsed < attemptTimeout ? attemptTimeout - elapsed : 1;
+				if ( wait > TIMEOUT_ACK_RECEIVE )
+					wait = TIMEOUT_ACK_RECEIVE;
+				reply_result = m_driver->recv(reply_src, reply_port, &dataACK, FRAME_MAX, wait); //no ack received
 				reply_len = reply_result >= 0 ? (uint8_t) reply_result : 0;
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+				if ( reply_result > 0 )
+					neighbourHeard(reply_src);
+#endif
 				MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Reply byte count=%d", reply_len);
 				
 				if ( reply_result > 0 ) {
@@ -141,7 +680,7 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 					//In case of FLOOD the above sendWithoutACK might have been missed by ALL neighbour nodes,
 					//so we try to detect this, fail quickly and re-send our FLOOD message, instead of
 					//waiting for the full timeout
-					if ( (msg->nwk_ctrl.delivery & DELIVERY_FLOOD) && (reply_msg.nwk_ctrl.delivery && DELIVERY_FLOOD) ) {
+					if ( (msg->nwk_ctrl.delivery & DELIVERY_FLOOD) && (reply_msg.nwk_ctrl.delivery & DELIVERY_FLOOD) ) {
 						oneFloodACK = oneFloodACK || (( reply_msg.nwk_ctrl.delivery & ACK ) &&
 													  ( reply_port == port && reply_msg.nwk_ctrl.seq == seq ));
 						MW_LOG_DEBUG(MW_LOG_NETWORKV1, "At least one FLOOD ACK received: %d", oneFloodACK);
@@ -150,6 +689,10 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 					
 					if ( reply_port != port || reply_msg.nwk_ctrl.seq != seq || !(reply_msg.nwk_ctrl.delivery & ACK)
 								|| ((reply_msg.nwk_ctrl.delivery & DELIVERY_DIRECT ) && reply_src != dest)
+#if MW_SUPPORT_DELIVERY_FLOOD
+								//a neighbour's FLOOD ACK carries no route; only the destination's ROUTED ACK completes the discovery
+								|| (reply_msg.nwk_ctrl.delivery & DELIVERY_FLOOD)
+#endif
 #if MW_SUPPORT_DELIVERY_ROUTED
 								|| ((msg->nwk_ctrl.delivery & DELIVERY_ROUTED
 	#if MW_SUPPORT_DELIVERY_FLOOD
@@ -157,12 +700,31 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 	#endif
 								//flood ack will always be via DELIVERY_ROUTED, so it is safe to use msg_routed here
 								) && reply_msg.msg_routed.route_info.route.dst != msg->msg_routed.route_info.route.dst )
-#endif							
+								//the same seq also goes to the late replies of a FLOOD discovery
+								|| ((msg->nwk_ctrl.delivery & DELIVERY_ROUTED) &&
+	#if MW_SUPPORT_ROUTE_REPAIR
+										//a relay may have changed the route on the way
+										!(reply_msg.nwk_ctrl.delivery & ROUTE_REPAIRED) &&
+	#endif
+										!is_same_route(&reply_msg.msg_routed.route_info.route, &msg->msg_routed.route_info.route))
+#endif
+								|| ((msg->nwk_ctrl.delivery & DELIVERY_DIRECT) && !(reply_msg.nwk_ctrl.delivery & DELIVERY_DIRECT))							
 //								|| reply_port != port )// not sure if this is always the case?
 								) {
 							ignored = true;
 							MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Not ACK, ignore, code: %d", reply_result);
 							MW_LOG_NOTICE(MW_LOG_NETWORKV1, "\t\tPort=%d, seq=%d, deliv=%d, reply src=%d", reply_port, reply_msg.nwk_ctrl.seq, reply_msg.nwk_ctrl.delivery, reply_src);
+							bool handled = false;
+#if MW_SUPPORT_ASYNC_SEND
+							//not our ACK, but it may be one for an asynchronous send
+							handled = !m_driver->is_broadcast() && handlePendingACK(reply_src, reply_port, &reply_msg, reply_result);
+#endif
+#if MW_SUPPORT_RECV_QUEUE
+							//otherwise keep it for the next recv()
+							if ( !handled )
+								queueFrame(reply_src, reply_port, m_driver->is_broadcast(), dataACK, reply_result);
+#endif
+							UNUSED(handled);
 						}
 				}
 #if MW_SUPPORT_DELIVERY_FLOOD
@@ -177,7 +739,7 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 				MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Reply code=%d", reply_result);
 			} while ( !m_sendAbort &&
 						(reply_result < 0 || ignored) &&
-							(!Meshwork::Time::passed(RTC::since(start), ackTimeout)) );
+							(!Meshwork::Time::passed(RTC::since(start), attemptTimeout)) );
 			MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Out of loop w code: %d, reply len: %d, sendAbort: %d", reply_result, reply_len, m_sendAbort);
 			
 			if ( m_sendAbort ) { //user aborted; break the loop
@@ -185,8 +747,28 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 				break;
 			} else if ( ignored ) { //internal message to be ignored; loop back
 				result = OK_MESSAGE_IGNORED;
+#if MW_SUPPORT_ROUTE_ERROR
+			} else if ( reply_result > 0 && (reply_msg.nwk_ctrl.delivery & ROUTE_ERROR) ) { //a relay could not forward it; no use retrying this route
+				//the RouteProvider hears of it through link_failed() rather than route_failed()
+				routeBroken(&reply_msg);
+				result = ERROR_ROUTE_BROKEN;
+				break;
+#endif
 			} else if ( reply_result >= 0 ) { //response received correctly; break the loop
 				result = reply_result;
+				//after a retry we cannot tell which attempt is ACKed, so count from the first one;
+				//skipping those samples (Karn) would hide the slow ACKs of lossy links
+				bool lastAttempt = i == 0;
+#if MW_SUPPORT_DELIVERY_FLOOD
+				//FLOOD retries are further apart than any discovery round trip, so the ACK is for the last one;
+				//counting the earlier timeouts in would only grow the next ones
+				lastAttempt = lastAttempt || (msg->nwk_ctrl.delivery & DELIVERY_FLOOD);
+#endif
+				updateRTT(msg, dest, RTC::since(lastAttempt ? start : firstSent));
+#if MW_SUPPORT_ROUTE_REPAIR
+				if ( (msg->nwk_ctrl.delivery & DELIVERY_ROUTED) && (reply_msg.nwk_ctrl.delivery & ROUTE_REPAIRED) )
+					routeRepaired(&msg->msg_routed.route_info.route, &reply_msg.msg_routed.route_info.route);
+#endif
 				if ( reply_len > 0 )
 					MW_LOG_DEBUG_ARRAY(MW_LOG_NETWORKV1, PSTR("L2 DATA RECV: "), dataACK, reply_len);
 				
@@ -224,6 +806,11 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 					result = OK;//just need to make it > 0 to mark success
 				}
 				maxACKLen = reply_len;
+#if MW_SUPPORT_FRAGMENTATION
+				//the message is not complete yet; the payload lists the missing fragments
+				if ( reply_msg.nwk_ctrl.delivery & FRAGMENT )
+					result = OK_FRAGMENTS_MISSING;
+#endif
 				break;
 			} else { //some other error happened
 				if ( reply_result == -1 ) {//lenACK or RF RCV buffer overflow; break loop
@@ -258,24 +845,26 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendWithACK(uint8_t
 	return result;
 }
 
-Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendDirectACK(Meshwork::L3::Network::ACKProvider* ackProvider, univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort) {
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendDirectACK(Meshwork::L3::Network::ACKProvider* ackProvider, univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort,
+						uint8_t flags, const void* ack, uint8_t ackLen) {
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send to: %d:%d", hopSrc, hopPort);
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "ackProvider=%d, msg=%d, msq.seq=%d", ackProvider, msg, msg->nwk_ctrl.seq);
 	
 	msg_l3_status_t result = -1;
 	univmsg_t reply_msg;
 	reply_msg.msg_direct.nwk_ctrl.seq = msg->nwk_ctrl.seq;
-	reply_msg.msg_direct.nwk_ctrl.delivery = DELIVERY_DIRECT | ACK;
+	reply_msg.msg_direct.nwk_ctrl.delivery = DELIVERY_DIRECT | ACK | flags;
 	uint8_t origin = 0;
 	uint8_t dest = origin = hopSrc;
 	void* data = get_msg_payload(msg);
 	uint8_t dataLen = get_msg_payload_len(msg);
 	
 	uint8_t bufACK[ACK_PAYLOAD_MAX];
-	uint8_t bufACKsize = 0;
-	if (ackProvider != NULL) {
-		bufACKsize = ackProvider->returnACKPayload(origin, hopPort, data, dataLen, bufACK, ACK_PAYLOAD_MAX);
-	}
+	uint8_t bufACKsize = ackLen;
+	if ( ack != NULL )
+		memcpy(bufACK, ack, ackLen);
+	else
+		bufACKsize = getACKPayload(ackProvider, origin, hopPort, data, dataLen, bufACK);
 	reply_msg.msg_direct.data = bufACKsize == 0 ? NULL : bufACK;
 	reply_msg.msg_direct.dataLen = bufACKsize;
 	
@@ -300,14 +889,16 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendDirectACK(Meshw
 }
 
 #if MW_SUPPORT_DELIVERY_ROUTED
-Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendRoutedACK(Meshwork::L3::Network::ACKProvider* ackProvider, univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort) {
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendRoutedACK(Meshwork::L3::Network::ACKProvider* ackProvider, univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort,
+						uint8_t flags, const void* ack, uint8_t ackLen) {
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send to: hopSrc=%d, hopPort=%d", hopSrc, hopPort);
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "ackProvider=%d, msg=%d", ackProvider, msg);
 	
 	msg_l3_status_t result = OK;
 	univmsg_t reply_msg;
 	reply_msg.msg_routed.nwk_ctrl.seq = msg->nwk_ctrl.seq;
-	reply_msg.msg_routed.nwk_ctrl.delivery = msg->nwk_ctrl.delivery | ACK;
+	//a FLOOD is answered over the route it has discovered
+	reply_msg.msg_routed.nwk_ctrl.delivery = ((msg->nwk_ctrl.delivery & DELIVERY_FLOOD) ? DELIVERY_ROUTED : (msg->nwk_ctrl.delivery & ~FRAGMENT)) | ACK | flags;
 	memcpy(&reply_msg.msg_routed.route_info, &msg->msg_routed.route_info, sizeof(msg->msg_routed.route_info));
 	reply_msg.msg_routed.route_info.breadcrumbs = 0;
 	uint8_t origin = 0;
@@ -337,11 +928,12 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendRoutedACK(Meshw
 #endif
 	}
 	
-	uint8_t bufACKsize = 0;
 	uint8_t bufACK[ACK_PAYLOAD_MAX];
-	if (ackProvider != NULL) {
-		bufACKsize = ackProvider->returnACKPayload(origin, hopPort, data, dataLen, bufACK, ACK_PAYLOAD_MAX);
-	}
+	uint8_t bufACKsize = ackLen;
+	if ( ack != NULL )
+		memcpy(bufACK, ack, ackLen);
+	else
+		bufACKsize = getACKPayload(ackProvider, origin, hopPort, data, dataLen, bufACK);
 	reply_msg.msg_routed.data = bufACKsize == 0 ? NULL : bufACK;
 	reply_msg.msg_routed.dataLen = bufACKsize;
 
@@ -366,6 +958,409 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendRoutedACK(Meshw
 }
 #endif
 
+#if MW_SUPPORT_ROUTE_ERROR
+void Meshwork::L3::NetworkV1::NetworkV1::sendRouteError(uint8_t port, uint8_t* data, uint8_t len, uint8_t next) {
+	//nobody waits on the way back for a lost ACK or route error, so leave those to the originator's timeout
+	if ( data[1] & ACK )
+		return;
+	univmsg_t msg;
+	get_msg_routed_any(&msg, data, len);
+	uint8_t devaddr = m_driver->get_device_address();
+	uint8_t myHop = 1 + get_msg_routed_hop_index(&msg, devaddr);
+	if ( myHop == 0 )
+		return;
+	uint8_t dest = myHop == 1 ? msg.msg_routed.route_info.route.src : msg.msg_routed.route_info.route.hops[myHop - 2];
+	uint8_t link[2] = {devaddr, next};
+	//a repaired route stays acceptable to the originator
+	msg.nwk_ctrl.delivery = DELIVERY_ROUTED | ACK | ROUTE_ERROR | (msg.nwk_ctrl.delivery & ROUTE_REPAIRED);
+	msg.msg_routed.route_info.breadcrumbs = 0;
+	msg.msg_routed.data = link;
+	msg.msg_routed.dataLen = sizeof(link);
+
+	MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Send route error to: %d, link: %d-%d", dest, devaddr, next);
+
+	iovec_t toSend[MAX_IOVEC_MSG_SIZE];
+	iovec_t* vp = toSend;
+	vp = get_iovec_msg_routed(vp, &msg);
+
+	MW_LOG_DEBUG_VP_BYTES(MW_LOG_NETWORKV1, PSTR("L2 DATA SEND ROUTE ERROR: "), toSend);
+
+	MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(devaddr, dest, port, &msg);
+
+	bool sent = sendWithoutACK(dest, port, vp, m_retry+1);
+
+	MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_END(devaddr, dest, port, &msg, sent);
+	UNUSED(sent);
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::routeBroken(univmsg_t* msg) {
+	if ( msg->msg_routed.dataLen < 2 )
+		return;
+	uint8_t from = msg->msg_routed.data[0];
+	uint8_t to = msg->msg_routed.data[1];
+	MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Route error, link: %d-%d", from, to);
+	if ( m_advisor != NULL )
+		m_advisor->link_failed(from, to);
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+	for ( int i = 0; i < MAX_LAST_ROUTES; i ++ ) {
+		last_route_t* last = &m_lastRoutes[i];
+		if ( last->dst == 0 )
+			continue;
+		route_t route = {last->hopCount, m_driver->get_device_address(), last->hops, last->dst};
+		if ( has_link(&route, from, to) )
+			last->dst = 0;
+	}
+	#endif
+}
+#endif
+
+#if MW_SUPPORT_ROUTE_REPAIR
+bool Meshwork::L3::NetworkV1::NetworkV1::repairRoute(uint8_t port, uint8_t* data, uint8_t len, uint8_t next, uint8_t attempts) {
+	//an ACK goes back the way it came; the originator retries instead
+	if ( m_advisor == NULL || (data[1] & ACK) )
+		return false;
+	univmsg_t msg;
+	get_msg_routed_any(&msg, data, len);
+	route_t* route = &msg.msg_routed.route_info.route;
+	uint8_t devaddr = m_driver->get_device_address();
+	uint8_t myHop = 1 + get_msg_routed_hop_index(&msg, devaddr);
+	if ( myHop == 0 )
+		return false;
+	//aim for the destination first, then for the nodes closer to us, down to next over another link
+	for ( uint8_t target = route->hopCount + 1; target > myHop; target -- ) {
+		uint8_t dst = target > route->hopCount ? route->dst : route->hops[target - 1];
+		//the nodes of the route from target on are kept
+		uint8_t tail = target > route->hopCount ? 0 : route->hopCount - target + 1;
+		uint8_t count = m_advisor->get_routeCount(dst);
+		for ( int i = 0; i < count; i ++ ) {
+			route_t* detour = m_advisor->get_route(dst, i);
+			if ( detour == NULL || detour->src != devaddr || (target == myHop + 1 && detour->hopCount == 0) )
+				continue;
+			uint8_t hopCount = myHop + detour->hopCount + tail;
+			if ( hopCount > m_maxHops || hopCount > MAX_ROUTING_HOPS ||
+					get_payload_max(DELIVERY_ROUTED, hopCount) < msg.msg_routed.dataLen )
+				continue;
+			//neither over next nor over a node the route has already
+			bool valid = true;
+			for ( int j = 0; valid && j < detour->hopCount; j ++ ) {
+				uint8_t hop = detour->hops[j];
+				valid = hop != next && hop != route->src && hop != route->dst &&
+						memchr(route->hops, hop, myHop) == NULL &&
+						memchr(route->hops + target - 1, hop, tail) == NULL;
+			}
+			if ( !valid )
+				continue;
+
+			uint8_t hops[MAX_ROUTING_HOPS];
+			memcpy(hops, route->hops, myHop);
+			memcpy(hops + myHop, detour->hops, detour->hopCount);
+			memcpy(hops + myHop + detour->hopCount, route->hops + target - 1, tail);
+			univmsg_t repaired = msg;
+			repaired.nwk_ctrl.delivery |= ROUTE_REPAIRED;
+			repaired.msg_routed.route_info.route.hopCount = hopCount;
+			repaired.msg_routed.route_info.route.hops = hops;
+			//the positions after us have changed
+			repaired.msg_routed.route_info.breadcrumbs &= (1 << myHop) - 1;
+			uint8_t dest = detour->hopCount == 0 ? dst : detour->hops[0];
+
+			MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Route repaired around: %d, to: %d, via: %d", next, dst, dest);
+
+			iovec_t toSend[MAX_IOVEC_MSG_SIZE];
+			iovec_t* vp = toSend;
+			vp = get_iovec_msg_routed(vp, &repaired);
+
+			MW_LOG_DEBUG_VP_BYTES(MW_LOG_NETWORKV1, PSTR("L2 DATA SEND REPAIRED: "), toSend);
+
+			MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(devaddr, dest, port, &repaired);
+
+			bool sent = sendWithoutACK(dest, port, vp, attempts);
+
+			MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_END(devaddr, dest, port, &repaired, sent);
+
+			if ( sent )
+				return true;
+		}
+	}
+	return false;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::routeRepaired(route_t* sent, route_t* repaired) {
+	//the broken link starts where the two routes part
+	uint8_t i = 0;
+	while ( i < sent->hopCount && i < repaired->hopCount && sent->hops[i] == repaired->hops[i] )
+		i ++;
+	uint8_t from = i == 0 ? sent->src : sent->hops[i - 1];
+	uint8_t to = i < sent->hopCount ? sent->hops[i] : sent->dst;
+	MW_LOG_NOTICE(MW_LOG_NETWORKV1, "ACK over a repaired route, hops=%d, link: %d-%d", repaired->hopCount, from, to);
+	if ( m_advisor != NULL ) {
+		m_advisor->link_failed(from, to);
+		m_advisor->route_found(repaired);
+	}
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+	setLastRoute(repaired->dst, repaired);
+	m_routeRepaired = true;
+	#endif
+}
+#endif
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::get_payload_max(uint8_t delivery, uint8_t hopCount) {
+	uint8_t header = sizeof(nwk_ctrl_t);
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( delivery & DELIVERY_ROUTED )
+	#if MW_SUPPORT_COMPACT_HEADER
+		//src, hops and dst; the hop count is part of NWKCTRL
+		header += hopCount <= ROUTED_COMPACT_HOPS ? 2 + hopCount : 4 + hopCount;
+	#else
+		//hop count, src, hops, dst and breadcrumbs
+		header += 4 + hopCount;
+	#endif
+#else
+	UNUSED(delivery);
+	UNUSED(hopCount);
+#endif
+	return m_driverCaps.payload_max > header ? m_driverCaps.payload_max - header : 0;
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::copyPayload(void* newData, size_t& newDataLenMax, const void* data, uint8_t len) {
+	if ( len > newDataLenMax ) {
+		MW_LOG_ERROR(MW_LOG_NETWORKV1, "Payload len: %d exceeds buffer: %d", len, newDataLenMax);
+#if MW_SUPPORT_DUPLICATE_DETECTION
+		//not delivered, so the retry must not be taken for a duplicate
+		if ( m_recentFrame != NULL )
+			m_recentFrame->origin = 0;
+#endif
+		return false;
+	}
+	newDataLenMax = len;
+	if ( len > 0 )
+		memcpy(newData, data, len);
+	return true;
+}
+
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendPayload(uint8_t attempts, uint16_t attemptsDelay,
+						uint8_t ack, uint32_t ackTimeout,
+						uint8_t dest, uint8_t port,
+						univmsg_t* msg, const void* buf, size_t len,
+						void* bufACK, size_t& maxACKLen) {
+	uint8_t hopCount = 0;
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( msg->nwk_ctrl.delivery & DELIVERY_ROUTED )
+		hopCount = msg->msg_routed.route_info.route.hopCount;
+#endif
+	uint8_t payloadMax = get_payload_max(msg->nwk_ctrl.delivery, hopCount);
+	if ( len > payloadMax ) {
+#if MW_SUPPORT_FRAGMENTATION
+		//fragments need an ACK, so no broadcast
+		if ( ack != 0 && payloadMax > FRAGMENT_HEADER_SIZE )
+			return sendFragments(attempts, attemptsDelay, ackTimeout, dest, port, payloadMax - FRAGMENT_HEADER_SIZE,
+									msg, buf, len, bufACK, maxACKLen);
+#endif
+		return ERROR_PAYLOAD_TOO_LONG;
+	}
+	set_msg_payload(msg, (uint8_t*) buf, len);
+#if MW_SUPPORT_DELIVERY_ROUTED
+	size_t none = 0;
+#endif
+	return sendWithACK(attempts, attemptsDelay, ack, ackTimeout, dest, port, msg, bufACK, maxACKLen
+#if MW_SUPPORT_DELIVERY_ROUTED
+						, NULL, none
+#endif
+						);
+}
+
+#if MW_SUPPORT_FRAGMENTATION
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::sendFragments(uint8_t attempts, uint16_t attemptsDelay, uint32_t ackTimeout,
+						uint8_t dest, uint8_t port, uint8_t size,
+						univmsg_t* msg, const void* buf, size_t len,
+						void* bufACK, size_t& maxACKLen) {
+	size_t count = (len + size - 1) / size;
+	if ( count > MAX_FRAGMENTS )//only on a long route over a driver with short frames
+		return ERROR_PAYLOAD_TOO_LONG;
+	uint32_t missing = ((uint32_t) 1 << count) - 1;
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send %d fragments of %d to: %d:%d", count, size, dest, port);
+
+	msg->nwk_ctrl.delivery |= FRAGMENT;
+	uint8_t fragment[FRAME_MAX];
+	uint8_t ack[ACK_PAYLOAD_MAX];
+	size_t ackLen = 0;
+	size_t none = 0;
+	msg_l3_status_t result = ERROR_ACK_NOT_RECEIVED;
+	//rounds without progress; each round resends what the destination reported missing
+	uint8_t stalls = 0;
+
+	while ( stalls < attempts ) {
+		uint8_t last = count - 1;
+		while ( !(missing & ((uint32_t) 1 << last)) )
+			last --;
+		for ( uint8_t i = 0; i <= last; i ++ ) {
+			if ( !(missing & ((uint32_t) 1 << i)) )
+				continue;
+			uint8_t fragmentLen = i == count - 1 ? len - i * size : size;
+			fragment[0] = i | (i == last ? FRAGMENT_ACK_REQUEST : 0);
+			fragment[1] = count;
+			fragment[2] = size;
+			memcpy(fragment + FRAGMENT_HEADER_SIZE, (uint8_t*) buf + i * size, fragmentLen);
+			set_msg_payload(msg, fragment, FRAGMENT_HEADER_SIZE + fragmentLen);
+			if ( i < last ) {
+				//the ACK to the last fragment of the round covers this one; a lost one is sent next round
+				result = sendWithACK(attempts, attemptsDelay, 0, 0, dest, port, msg, NULL, none
+#if MW_SUPPORT_DELIVERY_ROUTED
+									, NULL, none
+#endif
+									);
+			} else {
+				ackLen = ACK_PAYLOAD_MAX;
+				result = sendWithACK(attempts, attemptsDelay, ACK, ackTimeout, dest, port, msg, ack, ackLen
+#if MW_SUPPORT_DELIVERY_ROUTED
+									, NULL, none
+#endif
+									);
+			}
+			if ( result == ERROR_DRIVER_SEND_ABORTED )
+				return result;
+		}
+		if ( result != OK_FRAGMENTS_MISSING )
+			break;
+		uint32_t reported = 0;
+		for ( uint8_t i = 0; i < ackLen && i < (MAX_FRAGMENTS + 7) / 8; i ++ )
+			reported |= (uint32_t) ack[i] << (8 * i);
+		reported &= ((uint32_t) 1 << count) - 1;
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Fragments missing: %l", reported);
+		if ( reported == 0 || reported == missing )
+			stalls ++;
+		else
+			stalls = 0;
+		if ( reported != 0 )
+			missing = reported;
+		result = ERROR_ACK_NOT_RECEIVED;
+	}
+
+	if ( result > 0 ) {
+		if ( ackLen <= maxACKLen ) {
+			if ( ackLen > 0 )
+				memcpy(bufACK, ack, ackLen);
+			result = OK;
+		} else {
+			result = OK_WARNING_ACK_TOO_LONG;
+		}
+		maxACKLen = ackLen;
+	}
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Fragments result: %d", result);
+	return result;
+}
+
+Meshwork::L3::NetworkV1::NetworkV1::reassembly_t* Meshwork::L3::NetworkV1::NetworkV1::getReassembly(uint8_t origin, uint8_t port, uint8_t seq, uint8_t count) {
+	uint32_t now = RTC::millis();
+	reassembly_t* oldest = NULL;
+	uint32_t oldestAge = 0;
+	for ( int i = 0; i < MAX_REASSEMBLY_BUFFERS; i ++ ) {
+		reassembly_t* r = &m_reassembly[i];
+		uint32_t age = now - r->time;
+		bool stale = r->count == 0 || Meshwork::Time::passed(age, TIMEOUT_REASSEMBLY);
+		if ( !stale && r->origin == origin && r->port == port && r->seq == seq && r->count == count )
+			return r;
+		//free and stale buffers go first, then completed messages, then the oldest
+		age = stale ? (uint32_t) -1 : (r->done ? age + TIMEOUT_REASSEMBLY : age);
+		if ( oldest == NULL || age > oldestAge ) {
+			oldest = r;
+			oldestAge = age;
+		}
+	}
+	if ( oldest->count != 0 && !oldest->done && oldestAge != (uint32_t) -1 )
+		MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Dropping incomplete message: origin=%d, seq=%d", oldest->origin, oldest->seq);
+	memset(oldest, 0, sizeof(reassembly_t) - sizeof(oldest->data));
+	oldest->origin = origin;
+	oldest->port = port;
+	oldest->seq = seq;
+	oldest->count = count;
+	oldest->time = now;
+	return oldest;
+}
+
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recvFragment(uint8_t src, uint8_t port, univmsg_t* msg,
+						void* newData, size_t& newDataLenMax, Meshwork::L3::Network::ACKProvider* ackProvider) {
+	uint8_t* data = get_msg_payload(msg);
+	uint8_t dataLen = get_msg_payload_len(msg);
+	if ( dataLen < FRAGMENT_HEADER_SIZE )
+		return OK_MESSAGE_IGNORED;
+	uint8_t index = data[0] & ~FRAGMENT_ACK_REQUEST;
+	uint8_t count = data[1];
+	uint8_t size = data[2];
+	uint8_t fragmentLen = dataLen - FRAGMENT_HEADER_SIZE;
+	if ( count == 0 || count > MAX_FRAGMENTS || index >= count || index * size + fragmentLen > MESSAGE_MAX ||
+			(index < count - 1 ? fragmentLen != size : fragmentLen > size) ) {
+		MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Invalid fragment %d of %d, len: %d", index, count, fragmentLen);
+		return OK_MESSAGE_IGNORED;
+	}
+	bool direct = msg->nwk_ctrl.delivery & DELIVERY_DIRECT;
+	uint8_t origin = src;
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( !direct )
+		origin = msg->msg_routed.route_info.route.src;
+#endif
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Fragment %d of %d from: %d", index, count, origin);
+
+	msg_l3_status_t result = OK_MESSAGE_INTERNAL;
+	reassembly_t* r = getReassembly(origin, port, msg->nwk_ctrl.seq, count);
+	uint32_t all = ((uint32_t) 1 << count) - 1;
+	if ( r->size == 0 )
+		r->size = size;
+	if ( r->done || r->size != size ) {
+		result = OK_MESSAGE_IGNORED;
+	} else {
+		memcpy(r->data + index * size, data + FRAGMENT_HEADER_SIZE, fragmentLen);
+		r->received |= (uint32_t) 1 << index;
+		if ( index == count - 1 )
+			r->len = index * size + fragmentLen;
+		r->time = RTC::millis();
+		if ( r->received == all ) {
+			if ( r->len > newDataLenMax ) {
+				//no ACK either; the sender fails instead of believing it was delivered
+				MW_LOG_ERROR(MW_LOG_NETWORKV1, "Message too long: %d", r->len);
+				r->count = 0;
+				return ERROR_PAYLOAD_TOO_LONG;
+			}
+			MW_LOG_INFO(MW_LOG_NETWORKV1, "Message complete, len: %d", r->len);
+			newDataLenMax = r->len;
+			memcpy(newData, r->data, r->len);
+			r->done = true;
+			int ackLen = ackProvider == NULL ? 0 : ackProvider->returnACKPayload(origin, port, r->data, r->len, r->ack, ACK_PAYLOAD_MAX);
+			r->ackLen = ackLen > 0 && ackLen <= ACK_PAYLOAD_MAX ? ackLen : 0;
+#if MW_SUPPORT_DELIVERY_ROUTED
+			if ( !direct && msg->msg_routed.route_info.route.hopCount > 0 && m_advisor != NULL )
+				m_advisor->route_found(&msg->msg_routed.route_info.route);
+#endif
+			result = OK;
+		}
+	}
+
+	if ( data[0] & FRAGMENT_ACK_REQUEST ) {
+		uint8_t flags = 0;
+		uint8_t* ack = r->ack;
+		uint8_t ackLen = r->ackLen;
+		uint8_t bitmap[(MAX_FRAGMENTS + 7) / 8];
+		if ( !r->done ) {//list the missing fragments
+			uint32_t missing = ~r->received & all;
+			flags = FRAGMENT;
+			ack = bitmap;
+			ackLen = (count + 7) / 8;
+			for ( uint8_t i = 0; i < ackLen; i ++ )
+				bitmap[i] = (uint8_t) (missing >> (8 * i));
+		}
+		msg_l3_status_t sent;
+#if MW_SUPPORT_DELIVERY_ROUTED
+		if ( !direct )
+			sent = sendRoutedACK(NULL, msg, src, port, flags, ack, ackLen);
+		else
+#endif
+			sent = sendDirectACK(NULL, msg, src, port, flags, ack, ackLen);
+		if ( sent <= 0 )
+			result = ERROR_ACK_SEND_FAILED;
+	}
+	return result;
+}
+#endif
+
 Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delivery, uint8_t retry,
 					uint8_t dest, uint8_t port,
 					const void* buf, size_t len,
@@ -374,7 +1369,12 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "deliv=%d, retry=%d, buf=%d, bufACK=%d, lenACK=%d", delivery, retry, buf, bufACK, lenACK);
 	
 	msg_l3_status_t result = -1;
-	if (len <= PAYLOAD_MAX) {
+#if MW_SUPPORT_FRAGMENTATION
+	size_t maxLen = MESSAGE_MAX;
+#else
+	size_t maxLen = get_payload_max();
+#endif
+	if (len <= maxLen) {
 		seq++;
 		MW_LOG_INFO(MW_LOG_NETWORKV1, "New SEQ=%d", seq);
 		size_t none = 0;
@@ -384,21 +1384,81 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 		univmsg_t send_msg;
 		send_msg.nwk_ctrl.seq = seq;
 
-		//TODO If RouteCache is supported and DELIVERY_ROUTED is set - fist check if Last Working Route is present for the destination node before other options
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+		//first try the delivery that worked last time for the destination; if it fails, it is not tried again below
+		uint8_t lastDelivery = 0;
+		route_t lastRoute;
+		uint8_t lastHops[MAX_ROUTING_HOPS];
+		last_route_t* last = dest == Wireless::Driver::BROADCAST ? NULL : getLastRoute(dest);
+	#if MW_SUPPORT_ETX_ROUTING
+		//a route that works may still be the expensive one
+		if ( last != NULL && last->delivery == DELIVERY_ROUTED ) {
+			uint8_t order[MAX_RANKED_ROUTES];
+			uint16_t cost[MAX_RANKED_ROUTES];
+			//as getRouteETX(); the QoS of the last route is not known here
+			uint16_t lastCost = getLinkETX(last->hopCount == 0 ? dest : last->hops[0]) + last->hopCount * ETX_UNIT;
+			if ( rankRoutes(dest, order, cost) > 0 && cost[0] + ETX_UNIT / 2 < lastCost ) {
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Cheaper route than the last working one: %d < %d", cost[0], lastCost);
+				last = NULL;
+			}
+		}
+	#endif
+		if ( last != NULL && (deliv & last->delivery) && last->hopCount <= m_maxHops ) {
+			lastDelivery = last->delivery;
+			if ( lastDelivery == DELIVERY_DIRECT ) {
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Send DIRECT, last working", NULL);
+				send_msg.nwk_ctrl.delivery = DELIVERY_DIRECT;
+				result = sendPayload(count, RETRY_WAIT_DIRECT, ACK, TIMEOUT_ACK_DIRECT,
+										dest, port,	&send_msg, buf, len, bufACK, lenACK);
+			} else {
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Send ROUTED, last working", NULL);
+				memcpy(lastHops, last->hops, last->hopCount);
+				lastRoute.hopCount = last->hopCount;
+				lastRoute.src = m_driver->get_device_address();
+				lastRoute.hops = lastHops;
+				lastRoute.dst = dest;
+				send_msg.nwk_ctrl.delivery = DELIVERY_ROUTED;
+				send_msg.msg_routed.route_info.route = lastRoute;
+				send_msg.msg_routed.route_info.breadcrumbs = 0;
+				result = sendPayload(count, RETRY_WAIT_ROUTED, ACK, TIMEOUT_ACK_ROUTED,
+										lastRoute.hopCount == 0 ? dest : lastHops[0], port, &send_msg, buf, len, bufACK, lenACK);
+			}
+			result = result > 0 ? OK : result;
+	#if MW_SUPPORT_DELIVERY_PREDICTION
+			//a failed route is accounted for with the other routes below
+			if ( result == OK || (lastDelivery == DELIVERY_DIRECT && result != Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED) )
+				updateDeliveryStats(dest, lastDelivery, result == OK);
+	#endif
+			if ( result == OK || result == Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED ) {
+				deliv = 0;
+			} else {
+				MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Last working route failed: %d", dest);
+				clearLastRoute(dest);
+				deliv &= ~(lastDelivery & DELIVERY_DIRECT);
+			}
+		}
+#endif
+
+#if MW_SUPPORT_DELIVERY_PREDICTION
+		if ( dest != Wireless::Driver::BROADCAST )
+			deliv = predictDelivery(dest, deliv);
+#endif
 
 		//try all set delivery methods, starting from LSB
 		if (deliv & DELIVERY_DIRECT) {
 			MW_LOG_INFO(MW_LOG_NETWORKV1, "Send DIRECT", NULL);
 			send_msg.nwk_ctrl.delivery = DELIVERY_DIRECT;
-			send_msg.msg_direct.dataLen = len;
-			send_msg.msg_direct.data = (uint8_t*) buf;
-			result = sendWithACK(count, RETRY_WAIT_DIRECT, dest == Wireless::Driver::BROADCAST ? 0 : ACK, TIMEOUT_ACK_DIRECT,
-									dest, port,	&send_msg, bufACK, lenACK
-#if MW_SUPPORT_DELIVERY_ROUTED
-									, NULL, none
-#endif
-									);
+			result = sendPayload(count, RETRY_WAIT_DIRECT, dest == Wireless::Driver::BROADCAST ? 0 : ACK, TIMEOUT_ACK_DIRECT,
+									dest, port,	&send_msg, buf, len, bufACK, lenACK);
 			result = result > 0 ? OK : result;
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+			if ( result == OK && dest != Wireless::Driver::BROADCAST )
+				setLastRoute(dest, NULL);
+#endif
+#if MW_SUPPORT_DELIVERY_PREDICTION
+			if ( dest != Wireless::Driver::BROADCAST && result != Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED )
+				updateDeliveryStats(dest, DELIVERY_DIRECT, result == OK);
+#endif
 		}
 		if ( result != Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED ) {
 #if MW_SUPPORT_DELIVERY_ROUTED
@@ -407,29 +1467,52 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 				if ( dest == Wireless::Driver::BROADCAST ) {
 					result = Meshwork::L3::NetworkV1::NetworkV1::ERROR_DELIVERY_METHOD_INVALID;
 				} else {
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+					//keep the failure of the last working route if no other route is left
+					if ( lastDelivery != DELIVERY_ROUTED )
+	#endif
 					result = Meshwork::L3::NetworkV1::NetworkV1::ERROR_NO_KNOWN_ROUTES;
+	#if MW_SUPPORT_ETX_ROUTING
+					uint8_t routeOrder[MAX_RANKED_ROUTES];
+					uint16_t routeCost[MAX_RANKED_ROUTES];
+					uint8_t routeCount = rankRoutes(dest, routeOrder, routeCost);
+	#else
 					uint8_t routeCount = m_advisor != NULL ? m_advisor->get_routeCount(dest) : 0;
+	#endif
 					bool triedOnce = false;
 					if ( routeCount > 0 ) {
 						for ( int i = 0; i < routeCount; i ++ ) {
+	#if MW_SUPPORT_ETX_ROUTING
+							route_t* route = m_advisor->get_route(dest, routeOrder[i]);
+	#else
 							route_t* route = m_advisor->get_route(dest, i);
+	#endif
 							if (route != NULL) {
 								if (route->hopCount > m_maxHops) {
 									MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Route exceeds max hops, ignoring", NULL);
 									continue;
 								}
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+								if ( lastDelivery == DELIVERY_ROUTED && route->hopCount == lastRoute.hopCount &&
+										memcmp(route->hops, lastHops, route->hopCount) == 0 ) {
+									triedOnce = true;
+									continue;
+								}
+	#endif
 								triedOnce = true;
 								send_msg.nwk_ctrl.delivery = DELIVERY_ROUTED;
 								send_msg.msg_routed.route_info.route = *route;
 								send_msg.msg_routed.route_info.breadcrumbs = 0;
-								send_msg.msg_routed.dataLen = len;
-								send_msg.msg_routed.data = (uint8_t*) buf;
 
 								uint8_t hop = route->hopCount == 0 ? dest : ((uint8_t*)route->hops)[0];
 
-								result = sendWithACK(count, RETRY_WAIT_ROUTED, ACK, TIMEOUT_ACK_ROUTED,
-													hop, port,	&send_msg, bufACK, lenACK, NULL, none);
+								result = sendPayload(count, RETRY_WAIT_ROUTED, ACK, TIMEOUT_ACK_ROUTED,
+													hop, port,	&send_msg, buf, len, bufACK, lenACK);
 								result = result > 0 ? OK : result;
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+								if ( result == OK )
+									setLastRoute(dest, route);
+	#endif
 								if ( result == OK ||
 									 result == Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED )
 									break;
@@ -439,6 +1522,10 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 					if ( !triedOnce) {
 						MW_LOG_NOTICE(MW_LOG_NETWORKV1, "No routes to: %d", dest);
 					}
+	#if MW_SUPPORT_DELIVERY_PREDICTION
+					else if ( result != Meshwork::L3::Network::ERROR_DRIVER_SEND_ABORTED )
+						updateDeliveryStats(dest, DELIVERY_ROUTED, result == OK);
+	#endif
 				}
 			}
 	#if MW_SUPPORT_DELIVERY_FLOOD
@@ -466,25 +1553,67 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 					//call the impl method, which will increment the seq as well
 					if ( hopCount == 0 ) {//no hops inbetween, use direct
 						send_msg.nwk_ctrl.delivery = DELIVERY_DIRECT;
-						send_msg.msg_direct.dataLen = len;
-						send_msg.msg_direct.data = (uint8_t*) buf;
-						result = sendWithACK(count, RETRY_WAIT_ROUTED, dest == Wireless::Driver::BROADCAST ? 0 : ACK, TIMEOUT_ACK_DIRECT,
-												dest, port,	&send_msg, bufACK, lenACK, NULL, none);
+						//a fresh seq, so that the destination's replies to later copies of the discovery are not taken for the payload's ACK
+						seq++;
+						send_msg.nwk_ctrl.seq = seq;
+						result = sendPayload(count, RETRY_WAIT_ROUTED, dest == Wireless::Driver::BROADCAST ? 0 : ACK, TIMEOUT_ACK_DIRECT,
+												dest, port,	&send_msg, buf, len, bufACK, lenACK);
 						result = result > 0 ? OK : result;
+		#if MW_SUPPORT_LAST_WORKING_ROUTE
+						if ( result == OK )
+							setLastRoute(dest, NULL);
+		#endif
 					} else {//use routed and hops that we discovered
+						//from the attempt that was answered, as sendWithACK() takes it; the retry waits are no round trip
+						uint32_t discoveryRTT = RTC::since(m_lastAttempt);
+		#if MW_SUPPORT_MULTIPATH_DISCOVERY
+						//wait a little for the copies that took other ways, then go with the best;
+						//those much slower than the first are not worth the delay
+						discovered_route_t routes[MAX_DISCOVERED_ROUTES];
+						routes[0].hopCount = hopCount;
+						memcpy(routes[0].hops, hops, hopCount);
+						uint32_t window = 2 * discoveryRTT < m_discoveryWindow ? 2 * discoveryRTT : m_discoveryWindow;
+						uint8_t routeCount = window == 0 ? 1 :
+								collectRoutes(port, send_msg.nwk_ctrl.seq, dest, window, routes, 1);
+						returnRoute.hopCount = routes[0].hopCount;
+						memcpy(hops, routes[0].hops, routes[0].hopCount);
+		#endif
 						send_msg.nwk_ctrl.delivery = DELIVERY_ROUTED;
 						memcpy(&send_msg.msg_routed.route_info.route, &returnRoute, sizeof(returnRoute));
 						send_msg.msg_routed.route_info.breadcrumbs = 0;
-						send_msg.msg_routed.dataLen = len;
-						send_msg.msg_routed.data = (uint8_t*) buf;
+						//keep the route for the next sends; the discovery round trip bounds the one over the route
+						updateRTT(&send_msg, returnRoute.hops[0], discoveryRTT);
+						if ( m_advisor != NULL ) {
+							m_advisor->route_found(&returnRoute);
+		#if MW_SUPPORT_MULTIPATH_DISCOVERY
+							//the alternatives are untried for payload; they may take free slots, not evict
+							for ( int i = 1; i < routeCount; i ++ ) {
+								route_t alternative = returnRoute;
+								alternative.hopCount = routes[i].hopCount;
+								alternative.hops = routes[i].hops;
+								m_advisor->route_learned(&alternative);
+							}
+		#endif
+						}
 
-						result = sendWithACK(count, RETRY_WAIT_ROUTED, ACK, TIMEOUT_ACK_ROUTED,
-												send_msg.msg_routed.route_info.route.hops[0], port, &send_msg, bufACK, lenACK, NULL, none);
+						seq++;
+						send_msg.nwk_ctrl.seq = seq;
+						result = sendPayload(count, RETRY_WAIT_ROUTED, ACK, TIMEOUT_ACK_ROUTED,
+												send_msg.msg_routed.route_info.route.hops[0], port, &send_msg, buf, len, bufACK, lenACK);
 						result = result > 0 ? OK : result;
+		#if MW_SUPPORT_LAST_WORKING_ROUTE
+						if ( result == OK )
+							setLastRoute(dest, &returnRoute);
+		#endif
 					}
 				} else {
 					MW_LOG_NOTICE(MW_LOG_NETWORKV1, "No routes to: %d", dest);
 				}
+		#if MW_SUPPORT_DELIVERY_PREDICTION
+				//the route works again, or the destination is a neighbour after all
+				if ( result == OK )
+					updateDeliveryStats(dest, send_msg.nwk_ctrl.delivery, true);
+		#endif
 			}
 	#endif
 		}//abort send check
@@ -496,7 +1625,523 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send(uint8_t delive
 	return result;
 }
 
+#if MW_SUPPORT_ASYNC_SEND
+Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::send_async(uint8_t delivery, uint8_t retry,
+					uint8_t dest, uint8_t port,
+					const void* buf, size_t len,
+					SendListener* listener, uint8_t& handle) {
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Send async: %d:%d, len=%d", dest, port, len);
+
+	if ( len > PAYLOAD_MAX )
+		return Meshwork::L3::NetworkV1::NetworkV1::ERROR_PAYLOAD_TOO_LONG;
+	pending_send_t* p = NULL;
+	for ( int i = 0; i < MAX_PENDING_SENDS && p == NULL; i ++ )
+		if ( m_pending[i].state == PENDING_NONE )
+			p = &m_pending[i];
+	if ( p == NULL )
+		return Meshwork::L3::NetworkV1::NetworkV1::ERROR_SEND_QUEUE_FULL;
+
+	seq++;
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "New SEQ=%d", seq);
+	p->delivery = delivery == 0 ? m_delivery : delivery;
+	p->count = 1 + (retry == 255 ? m_retry : retry);
+	p->routeIndex = 0;
+	p->dest = dest;
+	p->port = port;
+	p->listener = listener;
+	p->result = Meshwork::L3::NetworkV1::NetworkV1::ERROR_DELIVERY_METHOD_INVALID;
+	p->msg.nwk_ctrl.seq = seq;
+	p->handle = seq;
+	p->len = len;
+	if ( len > 0 )
+		memcpy(p->data, buf, len);
+
+	if ( !nextPendingStep(p) )
+		return p->result;
+	handle = seq;
+	//transmit right away; a broadcast or a failing driver may complete the send already
+	pollPending(p);
+	return OK;
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::nextPendingStep(pending_send_t* p) {
+	uint8_t len = p->len;
+	p->state = PENDING_ACTIVE;
+	p->attempt = 0;
+	p->tries = 0;
+	if ( p->delivery & DELIVERY_DIRECT ) {
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Pending DIRECT", NULL);
+		p->delivery &= ~DELIVERY_DIRECT;
+		p->msg.nwk_ctrl.delivery = DELIVERY_DIRECT;
+		p->msg.msg_direct.dataLen = len;
+		p->msg.msg_direct.data = p->data;
+		p->timeoutMax = TIMEOUT_ACK_DIRECT;
+		p->timeout = getACKTimeout(&p->msg, p->dest, p->timeoutMax);
+		return true;
+	}
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( p->delivery & DELIVERY_ROUTED ) {
+		if ( p->dest != Wireless::Driver::BROADCAST ) {
+			p->result = Meshwork::L3::NetworkV1::NetworkV1::ERROR_NO_KNOWN_ROUTES;
+	#if MW_SUPPORT_ETX_ROUTING
+			//rank once; the failures of the routes tried change their cost
+			if ( p->routeIndex == 0 ) {
+				uint16_t cost[MAX_RANKED_ROUTES];
+				p->routeRanked = rankRoutes(p->dest, p->routeOrder, cost);
+			}
+			uint8_t routeCount = p->routeRanked;
+	#else
+			uint8_t routeCount = m_advisor != NULL ? m_advisor->get_routeCount(p->dest) : 0;
+	#endif
+			while ( p->routeIndex < routeCount ) {
+	#if MW_SUPPORT_ETX_ROUTING
+				route_t* route = m_advisor->get_route(p->dest, p->routeOrder[p->routeIndex ++]);
+	#else
+				route_t* route = m_advisor->get_route(p->dest, p->routeIndex ++);
+	#endif
+				if ( route == NULL || route->hopCount > m_maxHops ) {
+					MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Route invalid or exceeds max hops, ignoring", NULL);
+					continue;
+				}
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Pending ROUTED, route=%d", p->routeIndex - 1);
+				p->msg.nwk_ctrl.delivery = DELIVERY_ROUTED;
+				p->msg.msg_routed.route_info.route = *route;
+				//the provider's route may change while we wait, so keep a copy of the hops
+				if ( route->hopCount > 0 )
+					memcpy(p->hops, route->hops, route->hopCount);
+				p->msg.msg_routed.route_info.route.hops = p->hops;
+				p->msg.msg_routed.route_info.breadcrumbs = 0;
+				p->msg.msg_routed.dataLen = len;
+				p->msg.msg_routed.data = p->data;
+				p->timeoutMax = TIMEOUT_ACK_ROUTED;
+				p->timeout = getACKTimeout(&p->msg, p->dest, p->timeoutMax);
+				return true;
+			}
+			MW_LOG_NOTICE(MW_LOG_NETWORKV1, "No routes to: %d", p->dest);
+		}
+		p->delivery &= ~DELIVERY_ROUTED;
+	}
+	#if MW_SUPPORT_DELIVERY_FLOOD
+	if ( p->delivery & DELIVERY_FLOOD ) {
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Pending FLOOD", NULL);
+		p->delivery &= ~DELIVERY_FLOOD;
+		//same two-step process as send(): discover the route with an empty payload first
+		p->msg.nwk_ctrl.delivery = DELIVERY_FLOOD;
+		p->msg.msg_flood.flood_info.route.hopCount = 0;
+		p->msg.msg_flood.flood_info.route.src = m_driver->get_device_address();
+		p->msg.msg_flood.flood_info.route.dst = p->dest;
+		p->msg.msg_flood.dataLen = 0;
+		p->msg.msg_flood.data = NULL;
+		p->timeoutMax = TIMEOUT_ACK_FLOOD;
+		p->timeout = getACKTimeout(&p->msg, p->dest, p->timeoutMax);
+		return true;
+	}
+	#endif
+#endif
+	p->state = PENDING_NONE;
+	return false;
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::transmitPending(pending_send_t* p) {
+	uint8_t dest = p->dest;
+#if MW_SUPPORT_DELIVERY_ROUTED
+	if ( p->msg.nwk_ctrl.delivery & DELIVERY_ROUTED ) {
+		route_t* route = &p->msg.msg_routed.route_info.route;
+		dest = route->hopCount == 0 ? p->dest : route->hops[0];
+	}
+	#if MW_SUPPORT_DELIVERY_FLOOD
+	else if ( p->msg.nwk_ctrl.delivery & DELIVERY_FLOOD ) {
+		dest = Wireless::Driver::BROADCAST;
+	}
+	#endif
+#endif
+	iovec_t toSend[MAX_IOVEC_MSG_SIZE];
+	iovec_t* vp = toSend;
+	vp = get_iovec_msg(vp, &p->msg);
+
+	MW_LOG_DEBUG_VP_BYTES(MW_LOG_NETWORKV1, PSTR("L2 DATA TO SEND ASYNC: "), toSend);
+
+	MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(m_driver->get_device_address(), dest, p->port, &p->msg);
+
+	bool sent = sendWithoutACK(dest, p->port, vp, 1);
+
+	MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_END(m_driver->get_device_address(), dest, p->port, &p->msg, sent);
+
+	return sent;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::completePending(pending_send_t* p, Network::msg_l3_status_t result, void* bufACK, size_t lenACK) {
+	MW_LOG_INFO(MW_LOG_NETWORKV1, "Async send completed: handle=%d, result=%d", p->handle, result);
+	//free the slot first, so that the listener may start another send
+	p->state = PENDING_NONE;
+	if ( p->listener != NULL )
+		p->listener->send_completed(p->handle, result, bufACK, lenACK);
+}
 
+void Meshwork::L3::NetworkV1::NetworkV1::poll() {
+	for ( int i = 0; i < MAX_PENDING_SENDS; i ++ )
+		pollPending(&m_pending[i]);
+#if MW_SUPPORT_HOP_RELIABLE
+	for ( int i = 0; i < MAX_RELAY_FRAMES; i ++ )
+		pollRelay(&m_relayFrames[i]);
+#endif
+}
+
+#if MW_SUPPORT_HOP_RELIABLE
+bool Meshwork::L3::NetworkV1::NetworkV1::queueRelay(uint8_t dest, uint8_t port, const void* data, uint8_t len) {
+	for ( int i = 0; i < MAX_RELAY_FRAMES; i ++ ) {
+		relay_frame_t* r = &m_relayFrames[i];
+		if ( r->len != 0 )
+			continue;
+		r->len = len;
+		r->dest = dest;
+		r->port = port;
+		r->tries = 0;
+		r->firstTime = r->time = RTC::millis();
+		r->wait = getBackoff(0);
+		memcpy(r->data, data, len);
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Relay frame kept for retry: dest=%d", dest);
+		return true;
+	}
+	return false;
+}
+
+void Meshwork::L3::NetworkV1::NetworkV1::pollRelay(relay_frame_t* r) {
+	if ( r->len == 0 || !Meshwork::Time::passed(RTC::since(r->time), r->wait) )
+		return;
+	if ( sendWithoutACK(r->dest, r->port, r->data, r->len, 1) ) {
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Relay retry sent: dest=%d, tries=%d", r->dest, r->tries + 1);
+		r->len = 0;
+	} else if ( Meshwork::Time::passed(RTC::since(r->firstTime), m_relayWindow) ) {
+		MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Relay retry given up: dest=%d", r->dest);
+		bool repaired = false;
+	#if MW_SUPPORT_ROUTE_REPAIR
+		//we may have learned a way around the next hop meanwhile
+		repaired = repairRoute(r->port, r->data, r->len, r->dest, 1);
+	#endif
+	#if MW_SUPPORT_ROUTE_ERROR
+		if ( !repaired )
+			sendRouteError(r->port, r->data, r->len, r->dest);
+	#endif
+		UNUSED(repaired);
+		r->len = 0;
+	} else {
+		r->time = RTC::millis();
+		r->wait = getBackoff(++ r->tries);
+	}
+}
+#endif
+
+void Meshwork::L3::NetworkV1::NetworkV1::pollPending(pending_send_t* p) {
+	while ( p->state != PENDING_NONE ) {
+		if ( p->state == PENDING_RETRY ) {
+			if ( !Meshwork::Time::passed(RTC::since(p->time), p->wait) )
+				return;
+			p->state = PENDING_ACTIVE;
+		} else if ( p->state == PENDING_WAIT_ACK ) {
+			uint32_t elapsed = RTC::since(p->time);
+			bool unheard = false;
+#if MW_SUPPORT_DELIVERY_FLOOD
+			//fail early if no neighbour has heard our FLOOD, same as sendWithACK()
+			unheard = (p->msg.nwk_ctrl.delivery & DELIVERY_FLOOD) && !p->floodACK &&
+						Meshwork::Time::passed(elapsed, TIMEOUT_ACK_RECEIVE);
+#endif
+			if ( !unheard && !Meshwork::Time::passed(elapsed, p->timeout) )
+				return;
+			MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Async ACK not received, attempt=%d", p->attempt);
+			p->result = ERROR_ACK_NOT_RECEIVED;
+#if MW_SUPPORT_DELIVERY_FLOOD
+			if ( unheard )
+				p->result = FLOOD_NOT_RECEIVED_BY_NEIGHBOURS;
+#endif
+			p->state = PENDING_ACTIVE;
+#if MW_SUPPORT_RANDOM_BACKOFF
+			if ( p->attempt < p->count ) {//back off before the next attempt, as sendWithACK() does
+				p->state = PENDING_RETRY;
+				p->wait = getBackoff(p->attempt - 1);
+				p->time = RTC::millis();
+				continue;
+			}
+#endif
+		}
+		if ( p->tries == 0 && p->attempt >= p->count ) {
+#if MW_SUPPORT_DELIVERY_ROUTED
+			//notify RouteProvider about a failed route
+			if ( p->result == ERROR_ACK_NOT_RECEIVED && m_advisor != NULL && (p->msg.nwk_ctrl.delivery & DELIVERY_ROUTED) )
+				m_advisor->route_failed(&p->msg.msg_routed.route_info.route);
+#endif
+			if ( !nextPendingStep(p) ) {
+				completePending(p, p->result, NULL, 0);
+				return;
+			}
+		}
+		if ( p->tries == 0 ) {
+			//back off on each retry, up to the old constant
+			if ( p->attempt > 0 )
+				p->timeout = p->timeout * 2 < p->timeoutMax ? p->timeout * 2 : p->timeoutMax;
+			else
+				p->firstTime = RTC::millis();
+			p->attempt ++;
+		}
+		if ( transmitPending(p) ) {
+			p->tries = 0;
+			if ( p->dest == Wireless::Driver::BROADCAST && (p->msg.nwk_ctrl.delivery & DELIVERY_DIRECT) ) {
+				//direct broadcast is not ACKed
+				completePending(p, OK, NULL, 0);
+				return;
+			}
+			p->state = PENDING_WAIT_ACK;
+			p->floodACK = false;
+			p->time = RTC::millis();
+		} else {
+			//same as sendWithoutACK(): up to count driver sends per attempt, backing off in between
+			p->result = Meshwork::L3::NetworkV1::NetworkV1::ERROR_DRIVER_SEND_FAILED;
+			if ( ++ p->tries < p->count ) {
+				p->state = PENDING_RETRY;
+				p->wait = getBackoff(p->tries - 1);
+				p->time = RTC::millis();
+			} else {
+				p->tries = 0;
+			}
+		}
+	}
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::handlePendingACK(uint8_t src, uint8_t port, univmsg_t* reply, uint8_t len) {
+	for ( int i = 0; i < MAX_PENDING_SENDS; i ++ )
+		if ( handlePendingACK(&m_pending[i], src, port, reply, len) )
+			return true;
+	return false;
+}
+
+bool Meshwork::L3::NetworkV1::NetworkV1::handlePendingACK(pending_send_t* p, uint8_t src, uint8_t port, univmsg_t* reply, uint8_t len) {
+	if ( p->state != PENDING_WAIT_ACK || port != p->port || reply->nwk_ctrl.seq != p->msg.nwk_ctrl.seq ||
+			!(reply->nwk_ctrl.delivery & ACK) )
+		return false;
+	uint8_t delivery = reply->nwk_ctrl.delivery & ~ACK;
+#if MW_SUPPORT_ROUTE_ERROR
+	delivery &= ~ROUTE_ERROR;
+#endif
+#if MW_SUPPORT_ROUTE_REPAIR
+	delivery &= ~ROUTE_REPAIRED;
+#endif
+#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+	//the destination answers a FLOOD over the discovered route
+	if ( delivery == DELIVERY_ROUTED && p->msg.nwk_ctrl.delivery == DELIVERY_FLOOD )
+		delivery = DELIVERY_FLOOD;
+#endif
+	if ( delivery != p->msg.nwk_ctrl.delivery )
+		return false;
+	if ( delivery == DELIVERY_DIRECT ) {
+		if ( src != p->dest )
+			return false;
+	}
+#if MW_SUPPORT_DELIVERY_ROUTED
+	else if ( delivery == DELIVERY_ROUTED ) {
+		if ( reply->msg_routed.route_info.route.dst != p->dest )
+			return false;
+		//the same seq also goes to the late replies of a FLOOD discovery, as in sendWithACK()
+		if (
+	#if MW_SUPPORT_ROUTE_REPAIR
+				//a relay may have changed the route on the way
+				!(reply->nwk_ctrl.delivery & ROUTE_REPAIRED) &&
+	#endif
+				!is_same_route(&reply->msg_routed.route_info.route, &p->msg.msg_routed.route_info.route) )
+			return false;
+	#if MW_SUPPORT_ROUTE_ERROR
+		if ( reply->nwk_ctrl.delivery & ROUTE_ERROR ) {
+			//skip the attempts left on this route
+			routeBroken(reply);
+			p->result = ERROR_ROUTE_BROKEN;
+			p->state = PENDING_ACTIVE;
+			p->attempt = p->count;
+			p->tries = 0;
+			pollPending(p);
+			return true;
+		}
+	#endif
+	}
+	#if MW_SUPPORT_DELIVERY_FLOOD
+	else if ( delivery == DELIVERY_FLOOD ) {
+		if ( len == sizeof(nwk_ctrl_t) ) {//FLOOD ACK from a neighbour
+			p->floodACK = true;
+			return true;
+		}
+		route_t* route = &reply->msg_routed.route_info.route;
+		if ( route->dst != p->dest || route->hopCount > MAX_ROUTING_HOPS )
+			return false;
+		//Step 2: deliver the payload over the discovered route
+		MW_LOG_INFO(MW_LOG_NETWORKV1, "Async route found, hops=%d", route->hopCount);
+		//the discovery round trip of the last attempt, as sendWithACK() takes it
+		uint32_t discoveryRTT = RTC::since(p->time);
+		updateRTT(&p->msg, p->dest, discoveryRTT);
+		if ( route->hopCount == 0 ) {
+			p->msg.nwk_ctrl.delivery = DELIVERY_DIRECT;
+			p->msg.msg_direct.dataLen = p->len;
+			p->msg.msg_direct.data = p->data;
+			p->timeoutMax = TIMEOUT_ACK_DIRECT;
+			p->timeout = getACKTimeout(&p->msg, p->dest, p->timeoutMax);
+		} else {
+			p->msg.nwk_ctrl.delivery = DELIVERY_ROUTED;
+			p->msg.msg_routed.route_info.route = *route;
+			memcpy(p->hops, route->hops, route->hopCount);
+			p->msg.msg_routed.route_info.route.hops = p->hops;
+			p->msg.msg_routed.route_info.breadcrumbs = 0;
+			p->msg.msg_routed.dataLen = p->len;
+			p->msg.msg_routed.data = p->data;
+			//keep the route for the next sends, as send() does
+			updateRTT(&p->msg, p->dest, discoveryRTT);
+			if ( m_advisor != NULL )
+				m_advisor->route_found(&p->msg.msg_routed.route_info.route);
+			p->timeoutMax = TIMEOUT_ACK_ROUTED;
+			p->timeout = getACKTimeout(&p->msg, p->dest, p->timeoutMax);
+		}
+		//a fresh seq, so that the destination's replies to later copies of the discovery are not taken for the payload's ACK
+		seq++;
+		p->msg.nwk_ctrl.seq = seq;
+		p->state = PENDING_ACTIVE;
+		p->attempt = 0;
+		pollPending(p);
+		return true;
+	}
+	#endif
+#endif
+	//after a retry, count from the first attempt as sendWithACK() does
+	updateRTT(&p->msg, p->dest, RTC::since(p->attempt == 1 ? p->time : p->firstTime));
+#if MW_SUPPORT_ROUTE_REPAIR
+	if ( delivery == DELIVERY_ROUTED && (reply->nwk_ctrl.delivery & ROUTE_REPAIRED) )
+		routeRepaired(&p->msg.msg_routed.route_info.route, &reply->msg_routed.route_info.route);
+#endif
+	uint8_t lenACK = get_msg_payload_len(reply);
+	completePending(p, OK, lenACK == 0 ? NULL : get_msg_payload(reply), lenACK);
+	return true;
+}
+
+uint32_t Meshwork::L3::NetworkV1::NetworkV1::getPollTimeout() {
+	uint32_t result = 0;
+	for ( int i = 0; i < MAX_PENDING_SENDS; i ++ ) {
+		pending_send_t* p = &m_pending[i];
+		if ( p->state == PENDING_NONE )
+			continue;
+		uint32_t wait = 1;
+		if ( p->state == PENDING_RETRY ) {
+			uint32_t elapsed = RTC::since(p->time);
+			wait = elapsed < p->wait ? p->wait - elapsed : 1;
+		} else if ( p->state == PENDING_WAIT_ACK ) {
+			uint32_t timeout = p->timeout;
+#if MW_SUPPORT_DELIVERY_FLOOD
+			if ( (p->msg.nwk_ctrl.delivery & DELIVERY_FLOOD) && !p->floodACK )
+				timeout = TIMEOUT_ACK_RECEIVE;
+#endif
+			uint32_t elapsed = RTC::since(p->time);
+			wait = elapsed < timeout ? timeout - elapsed : 1;
+		}
+		if ( result == 0 || wait < result )
+			result = wait;
+	}
+#if MW_SUPPORT_HOP_RELIABLE
+	for ( int i = 0; i < MAX_RELAY_FRAMES; i ++ ) {
+		relay_frame_t* r = &m_relayFrames[i];
+		if ( r->len == 0 )
+			continue;
+		uint32_t elapsed = RTC::since(r->time);
+		uint32_t wait = elapsed < r->wait ? r->wait - elapsed : 1;
+		if ( result == 0 || wait < result )
+			result = wait;
+	}
+#endif
+	return result;
+}
+
+uint8_t Meshwork::L3::NetworkV1::NetworkV1::get_pending_count() {
+	uint8_t count = 0;
+	for ( int i = 0; i < MAX_PENDING_SENDS; i ++ )
+		if ( m_pending[i].state != PENDING_NONE )
+			count ++;
+	return count;
+}
+#endif
+
+
+int Meshwork::L3::NetworkV1::NetworkV1::recvFrame(uint8_t& src, uint8_t& port, bool& broadcast, uint8_t* data, uint32_t ms) {
+#if MW_SUPPORT_ASYNC_SEND
+	poll();
+#endif
+#if MW_SUPPORT_RECV_QUEUE
+	//frames that arrived while we were waiting for an ACK come first
+	if ( m_recvQueueCount > 0 ) {
+		queued_frame_t* frame = &m_recvQueue[m_recvQueueHead];
+		m_recvQueueHead = (m_recvQueueHead + 1) % MAX_QUEUED_FRAMES;
+		m_recvQueueCount --;
+		src = frame->src;
+		port = frame->port;
+		broadcast = frame->broadcast;
+		memcpy(data, frame->data, frame->len);
+		MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Dequeued frame, src=%d, len=%d", src, frame->len);
+		return frame->len;
+	}
+#endif
+#if MW_SUPPORT_ASYNC_SEND
+	//keep pending asynchronous sends going while waiting; wake up for their deadlines
+	int dataLen;
+	uint32_t start = RTC::millis();
+	for (;;) {
+		uint32_t wait = ms;
+		if ( ms != 0 ) {
+			uint32_t elapsed = RTC::since(start);
+			wait = elapsed < ms ? ms - elapsed : 1;
+		}
+		uint32_t pollWait = getPollTimeout();
+		bool capped = pollWait != 0 && (wait == 0 || pollWait < wait);
+		dataLen = m_driver->recv(src, port, data, FRAME_MAX, capped ? pollWait : wait);
+		if ( dataLen >= 0 || !capped )
+			break;
+		poll();
+	}
+#else
+	int dataLen = m_driver->recv(src, port, data, FRAME_MAX, ms);
+#endif
+	broadcast = m_driver->is_broadcast();
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+	if ( dataLen > 0 )
+		neighbourHeard(src);
+#endif
+	return dataLen;
+}
+
+#if MW_SUPPORT_RECV_QUEUE
+void Meshwork::L3::NetworkV1::NetworkV1::queueFrame(uint8_t src, uint8_t port, bool broadcast, uint8_t* data, uint8_t len) {
+	//ACKs for someone else's send are only useful to that sender
+	if ( len <= sizeof(nwk_ctrl_t) )
+		return;
+	#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_COMPACT_HEADER
+	//the delivery bits below do not apply to compact ROUTED frames
+	if ( !(data[1] & ROUTED_COMPACT) ) {
+	#endif
+	if ( (data[1] & (DELIVERY_DIRECT | ACK)) == (DELIVERY_DIRECT | ACK) )
+		return;
+	#if MW_SUPPORT_DELIVERY_FLOOD
+	//our own FLOOD echoed back by the neighbours
+	if ( (data[1] & DELIVERY_FLOOD) && !(data[1] & ACK) && data[3] == m_driver->get_device_address() )
+		return;
+	#endif
+	#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_COMPACT_HEADER
+	}
+	#endif
+	if ( m_recvQueueCount == MAX_QUEUED_FRAMES ) {
+		MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Receive queue full, dropping frame from: %d", src);
+		return;
+	}
+	queued_frame_t* frame = &m_recvQueue[(m_recvQueueHead + m_recvQueueCount) % MAX_QUEUED_FRAMES];
+	frame->src = src;
+	frame->port = port;
+	frame->broadcast = broadcast;
+	frame->len = len;
+	memcpy(frame->data, data, len);
+	m_recvQueueCount ++;
+	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "Queued frame, src=%d, len=%d", src, len);
+}
+#endif
 
 //receive a new message and call ackProvider to provide ACK payload. ACKs are ignored, since they are handled within send
 Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src, uint8_t& port,
@@ -505,18 +2150,17 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Recv: timeout(ms)=%l, newDataLenMax=%d, ackProvider=%d", ms, newDataLenMax, ackProvider);
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "&src=%d, &port=%d, newData=%d, newDataLenMax=%d, ackProvider=%d", &src, &port, newData, newDataLenMax, ackProvider);
 
-	uint8_t data[ACK_PAYLOAD_MAX];
+	uint8_t data[FRAME_MAX];
 //	uint8_t src, port;//use local vars to reduce code size
 
 	MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_RECV_BEGIN();
 
-	int dataLen = m_driver->recv(src, port, &data, PAYLOAD_MAX, ms);
+	bool broadcast = false;
+	int dataLen = recvFrame(src, port, broadcast, data, ms);
 
 	msg_l3_status_t result = dataLen;
 //	srcA = src;
 //	portA = port;
-	
-	//TODO Update Last Working Route per node in RouteCache when receiving messages from any node
 
 	if (result > 0) { //not timeouted, no crc error
 		MW_LOG_INFO(MW_LOG_NETWORKV1, "Received data, len: %d", result);
@@ -526,50 +2170,127 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 		univmsg_t recv_msg;
 		get_msg(&recv_msg, data, result);//fill in the msg structure
 
-		MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_RECV_END(m_driver->is_broadcast(), src, port, &recv_msg);
+		MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_RECV_END(broadcast, src, port, &recv_msg);
 
-		if ( !m_driver->is_broadcast() ) {//send to a specific destination
-			if (recv_msg.nwk_ctrl.delivery & DELIVERY_DIRECT) { //Direct Send
+#if MW_SUPPORT_DELIVERY_PREDICTION
+		//src has just reached us, so DIRECT is worth trying again
+		heardDirect(src);
+#endif
+
+#if MW_SUPPORT_ASYNC_SEND
+		if ( !broadcast && handlePendingACK(src, port, &recv_msg, result) ) {
+			MW_LOG_INFO(MW_LOG_NETWORKV1, "Received ACK for async send", NULL);
+			result = OK_MESSAGE_INTERNAL;
+		} else
+#endif
+		if ( !broadcast ) {//send to a specific destination
+			if ( (recv_msg.nwk_ctrl.delivery & (DELIVERY_DIRECT | ACK)) == (DELIVERY_DIRECT | ACK) ) {
+				//late ACK for a send that has already completed
+				MW_LOG_NOTICE(MW_LOG_NETWORKV1, "Late ACK, ignoring", NULL);
+				result = OK_MESSAGE_IGNORED;
+			}
+#if MW_SUPPORT_FRAGMENTATION
+			else if ( (recv_msg.nwk_ctrl.delivery & (FRAGMENT | ACK)) == FRAGMENT &&
+						( (recv_msg.nwk_ctrl.delivery & DELIVERY_DIRECT)
+	#if MW_SUPPORT_DELIVERY_ROUTED
+						|| recv_msg.msg_routed.route_info.route.dst == m_driver->get_device_address()
+	#endif
+						) ) {
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Received FRAGMENT", NULL);
+				result = recvFragment(src, port, &recv_msg, newData, newDataLenMax, ackProvider);
+			}
+#endif
+#if MW_SUPPORT_DUPLICATE_DETECTION
+			else if ( (recv_msg.nwk_ctrl.delivery & DELIVERY_DIRECT) &&
+						isDuplicate(src, port, recv_msg.nwk_ctrl.seq, false) ) {
+				//our ACK got lost, so ACK again without delivering the payload
+				result = sendDirectACK(ackProvider, &recv_msg, src, port);
+				result = result > 0 ? OK_MESSAGE_IGNORED : result;
+			}
+#endif
+			else if (recv_msg.nwk_ctrl.delivery & DELIVERY_DIRECT) { //Direct Send
 				//here we assume the driver does not let us receive messages that are not for us!
 				MW_LOG_INFO(MW_LOG_NETWORKV1, "Received DIRECT", NULL);
 				//copy real payload. use temp var to reduce code size
 				uint8_t len = recv_msg.msg_direct.dataLen;
-				newDataLenMax = len;
-				if ( len > 0 )
-					memcpy(newData, recv_msg.msg_direct.data, len);
 				MW_LOG_INFO(MW_LOG_NETWORKV1, "Payload len: %d", len);
-				
-				result = sendDirectACK(ackProvider, &recv_msg, src, port);
-				result = result > 0 ? OK : result;
+				if ( copyPayload(newData, newDataLenMax, recv_msg.msg_direct.data, len) ) {
+					result = sendDirectACK(ackProvider, &recv_msg, src, port);
+					result = result > 0 ? OK : result;
+				} else {
+					result = ERROR_PAYLOAD_TOO_LONG;
+				}
 			}
 #if MW_SUPPORT_DELIVERY_ROUTED
 			else if (recv_msg.nwk_ctrl.delivery & DELIVERY_ROUTED) { //Routed Send
 				uint8_t devaddr = m_driver->get_device_address();
+	#if MW_SUPPORT_DUPLICATE_DETECTION
+				if (devaddr == recv_msg.msg_routed.route_info.route.dst &&
+						isDuplicate(recv_msg.msg_routed.route_info.route.src, port, recv_msg.msg_routed.nwk_ctrl.seq, false)) {
+					//our ACK got lost, so ACK again without delivering the payload
+					result = sendRoutedACK(ackProvider, &recv_msg, src, port);
+					result = result > 0 ? OK_MESSAGE_IGNORED : result;
+				} else
+	#endif
 				if (devaddr == recv_msg.msg_routed.route_info.route.dst) { //we are the route dest
 					MW_LOG_INFO(MW_LOG_NETWORKV1, "Received ROUTED to us", NULL);
 					if (recv_msg.msg_routed.route_info.route.hopCount > 0 && m_advisor != NULL)
 						m_advisor->route_found(&recv_msg.msg_routed.route_info.route);
+	#if MW_SUPPORT_ROUTE_LEARNING
+					//the way back to the originator
+					learnRoute(&recv_msg.msg_routed.route_info.route, recv_msg.msg_routed.route_info.route.hopCount + 1, true);
+	#endif
 					//copy real payload. use temp var to reduce code size
 					uint8_t len = recv_msg.msg_routed.dataLen;
-					newDataLenMax = len;
-					if ( len > 0 )
-						memcpy(newData, recv_msg.msg_routed.data, len);
 					MW_LOG_INFO(MW_LOG_NETWORKV1, "Payload len: %d", len);
-
-					result = sendRoutedACK(ackProvider, &recv_msg, src, port);
-					result = result > 0 ? OK : result;
+					if ( copyPayload(newData, newDataLenMax, recv_msg.msg_routed.data, len) ) {
+						result = sendRoutedACK(ackProvider, &recv_msg, src, port);
+						result = result > 0 ? OK : result;
+					} else {
+						result = ERROR_PAYLOAD_TOO_LONG;
+					}
+	#if MW_SUPPORT_ROUTE_ERROR
+				} else if ( (recv_msg.nwk_ctrl.delivery & ROUTE_ERROR) && devaddr == recv_msg.msg_routed.route_info.route.src ) {
+					//too late for the send, but the next ones should avoid the broken link
+					routeBroken(&recv_msg);
+					result = OK_MESSAGE_INTERNAL;
+	#endif
 				} else {//re-route, but first check and update breadcrumbs. if ACK use reverse order to determine next dest
 	#if MW_SUPPORT_REROUTING
 					MW_LOG_INFO(MW_LOG_NETWORKV1, "Received ROUTED to reroute", NULL);
 					uint8_t myHop = 1 + get_msg_routed_hop_index(&recv_msg, m_driver->get_device_address());
+					uint8_t hopCount = recv_msg.msg_routed.route_info.route.hopCount;
 					if (myHop > 0) {//offset by 1 since we use it for bitmask
-						if ( !(recv_msg.msg_routed.route_info.breadcrumbs & (1 << (myHop - 1))) ) {//our bit not set
+						bool visited = recv_msg.msg_routed.route_info.breadcrumbs & (1 << (myHop - 1));
+		#if MW_SUPPORT_COMPACT_HEADER
+						bool compact = ((uint8_t *)data)[1] & ROUTED_COMPACT;
+						if ( compact )//no breadcrumbs, so a route through us twice would loop
+							visited = memchr(recv_msg.msg_routed.route_info.route.hops + myHop, m_driver->get_device_address(), hopCount - myHop) != NULL;
+		#endif
+						if ( !visited ) {//our bit not set
+		#if MW_SUPPORT_COMPACT_HEADER
+							if ( !compact )
+		#endif
 							//ok, modifyfing the buf directly instead of using recv_msg
 							//and transforming back to a data array is ugly, but more efficient
-							((uint8_t *)data)[5 + recv_msg.msg_routed.route_info.route.hopCount] |= 1 << (myHop - 1);//update breadcrumbs
+							((uint8_t *)data)[5 + hopCount] |= 1 << (myHop - 1);//update breadcrumbs
+		#if MW_SUPPORT_ROUTE_LEARNING
+							//we relay both ways, so the route works from here to either end;
+							//not so for the route of a broken link report
+							if ( !(recv_msg.nwk_ctrl.delivery & ROUTE_ERROR) ) {
+								learnRoute(&recv_msg.msg_routed.route_info.route, myHop, true);
+								learnRoute(&recv_msg.msg_routed.route_info.route, myHop, false);
+							}
+		#endif
+		#if MW_SUPPORT_ROUTE_ERROR
+							if ( recv_msg.nwk_ctrl.delivery & ROUTE_ERROR )
+								routeBroken(&recv_msg);
+		#endif
 							//ACK route traverses -1 to Src, send route traverses +1 to Dst
-							uint8_t hopIndex = myHop + ((recv_msg.nwk_ctrl.delivery == (DELIVERY_ROUTED | ACK)) ? -1 : 1);
-							uint8_t dest = ((uint8_t *)data)[3 + hopIndex];
+							uint8_t hopIndex = myHop + ((recv_msg.nwk_ctrl.delivery & ACK) ? -1 : 1);
+							uint8_t dest = hopIndex == 0 ? recv_msg.msg_routed.route_info.route.src :
+											hopIndex > hopCount ? recv_msg.msg_routed.route_info.route.dst :
+											recv_msg.msg_routed.route_info.route.hops[hopIndex - 1];
 							
 							//ACK to the immediate sender first is NOT needed, since:
 							//1) The sender only needs RF-level confirmation that the message has been received,
@@ -590,7 +2311,23 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 							MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(src, dest, port, &msg);
 		#endif
 							
-							bool sent = sendWithoutACK(dest, port, data, dataLen, m_retry+1);
+		#if MW_SUPPORT_HOP_RELIABLE
+							//retry from poll(), so that we keep receiving meanwhile
+							uint8_t attempts = m_relayWindow > 0 ? 1 : m_retry+1;
+		#else
+							uint8_t attempts = m_retry+1;
+		#endif
+							bool sent = sendWithoutACK(dest, port, data, dataLen, attempts);
+		#if MW_SUPPORT_HOP_RELIABLE
+							if ( !sent && m_relayWindow > 0 )
+								sent = queueRelay(dest, port, data, dataLen);
+		#endif
+		#if MW_SUPPORT_ROUTE_REPAIR
+							//another way may still get there, without a retransmission from the originator;
+							//a kept frame is repaired by pollRelay() once its retries are used up
+							if ( !sent )
+								sent = repairRoute(port, data, dataLen, dest, attempts);
+		#endif
 
 		#if MW_SUPPORT_RADIO_LISTENER
 							MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(src, dest, port, &msg);
@@ -599,6 +2336,15 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 							result = sent ? OK_MESSAGE_IGNORED : Meshwork::L3::NetworkV1::NetworkV1::ERROR_REROUTE_FAILED;
 							if ( !sent )
 								MW_LOG_NOTICE(MW_LOG_NETWORKV1, "REROUTE driver send failed to: dest=%d", dest, port);
+		#if MW_SUPPORT_ROUTE_ERROR
+							//a full relay queue says nothing about the link; pollRelay() reports the kept frames
+							if ( !sent
+			#if MW_SUPPORT_HOP_RELIABLE
+									&& m_relayWindow == 0
+			#endif
+									)
+								sendRouteError(port, data, dataLen, dest);
+		#endif
 						} else {//we are already in the breadcrumbs
 							result = OK_MESSAGE_IGNORED;
 						}
@@ -622,6 +2368,11 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 			}
 #if MW_SUPPORT_DELIVERY_ROUTED
 	#if MW_SUPPORT_DELIVERY_FLOOD
+			else if ( (recv_msg.nwk_ctrl.delivery & DELIVERY_FLOOD) &&
+						recv_msg.msg_flood.flood_info.route.src == m_driver->get_device_address() ) {
+				MW_LOG_INFO(MW_LOG_NETWORKV1, "Received our own FLOOD from addr=%d, ignoring", src);
+				result = OK_MESSAGE_IGNORED;
+			}
 			else if (recv_msg.nwk_ctrl.delivery & DELIVERY_FLOOD) {
 				uint8_t routeHops = recv_msg.msg_flood.flood_info.route.hopCount;
 				MW_LOG_INFO(MW_LOG_NETWORKV1, "Received BROADCAST FLOOD from addr=%d, hopCount=%d", src, routeHops);
@@ -646,36 +2397,65 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 		#endif
 
 				uint8_t devaddr = m_driver->get_device_address();
+		#if MW_SUPPORT_DUPLICATE_DETECTION
+				//the same FLOOD arrives via several neighbours; answer or rebroadcast it once
+				if (isDuplicate(recv_msg.msg_flood.flood_info.route.src, port, recv_msg.msg_flood.nwk_ctrl.seq, true)) {
+			#if MW_SUPPORT_MULTIPATH_DISCOVERY
+					//answer every copy of a discovery, so that the originator can choose the route
+					if (devaddr == recv_msg.msg_flood.flood_info.route.dst && recv_msg.msg_flood.dataLen == 0) {
+						result = sendRoutedACK(NULL, &recv_msg, src, port);
+						result = result > 0 ? OK_MESSAGE_INTERNAL : ERROR_ACK_SEND_FAILED;
+					} else
+			#endif
+					result = OK_MESSAGE_IGNORED;
+				} else
+		#endif
 				if (devaddr == recv_msg.msg_flood.flood_info.route.dst) {//we are the ultimate receiver, ask for payload and generate a routed ACK
 					//we could have optimized to check if hopCount == 0 and send direct ack
 					//but that would have increased the code at both sender and receiver side
 					MW_LOG_INFO(MW_LOG_NETWORKV1, "Message to us, sending ROUTED ACK", NULL);
 					if (routeHops > 0 && m_advisor != NULL)
 						m_advisor->route_found(&recv_msg.msg_flood.flood_info.route);
+			#if MW_SUPPORT_ROUTE_LEARNING
+					learnRoute(&recv_msg.msg_flood.flood_info.route, routeHops + 1, true);
+			#endif
 					uint8_t len = recv_msg.msg_flood.dataLen;//local var reduces code size
-					newDataLenMax = len;
-					if ( len > 0 )
-						memcpy(newData, recv_msg.msg_flood.data, len);
-					result = sendRoutedACK(ackProvider, &recv_msg, src, port);
-					//empty payload means internal flood discovery message, which the user should not care about
-					result = result > 0 ? (len == 0 ? OK_MESSAGE_INTERNAL : OK ) : ERROR_ACK_SEND_FAILED;
+					if ( copyPayload(newData, newDataLenMax, recv_msg.msg_flood.data, len) ) {
+						result = sendRoutedACK(ackProvider, &recv_msg, src, port);
+						//empty payload means internal flood discovery message, which the user should not care about
+						result = result > 0 ? (len == 0 ? OK_MESSAGE_INTERNAL : OK ) : ERROR_ACK_SEND_FAILED;
+					} else {
+						result = ERROR_PAYLOAD_TOO_LONG;
+					}
 		#if MW_SUPPORT_REROUTING
 				} else if (routeHops < m_maxHops) {//rebroadcast the message
-					uint8_t myHop = 1 + get_msg_routed_hop_index(&recv_msg, m_driver->get_device_address());
+					uint8_t myHop = 1 + get_msg_flood_hop_index(&recv_msg, devaddr);
 					if (myHop == 0) {//not in the hop list, add us
 						MW_LOG_INFO(MW_LOG_NETWORKV1, "Will REBROADCAST", NULL);
+			#if MW_SUPPORT_ROUTE_LEARNING
+						//overheard: the FLOOD came to us along these hops
+						learnRoute(&recv_msg.msg_flood.flood_info.route, routeHops + 1, true);
+			#endif
 						uint8_t newHops[routeHops + 1];
-						if (routeHops > 0)	//copy existing hops incl src, excl dst
+						if (routeHops > 0)	//copy existing hops, excl src and dst
 							memcpy(newHops, recv_msg.msg_flood.flood_info.route.hops, routeHops);
-						newHops[routeHops] = recv_msg.msg_flood.flood_info.route.dst;
-						uint8_t newMsg[++dataLen];
-						get_msg_flood(&recv_msg, newMsg, dataLen);
+						newHops[routeHops] = devaddr;
+						recv_msg.msg_flood.flood_info.route.hopCount = routeHops + 1;
+						recv_msg.msg_flood.flood_info.route.hops = newHops;
+						iovec_t toSend[MAX_IOVEC_MSG_SIZE];
+						iovec_t* vp = toSend;
+						vp = get_iovec_msg_flood(vp, &recv_msg);
 						
-						MW_LOG_DEBUG_ARRAY(MW_LOG_NETWORKV1, PSTR("L2 DATA SEND REBROADCAST: "), newMsg, dataLen);
+						MW_LOG_DEBUG_VP_BYTES(MW_LOG_NETWORKV1, PSTR("L2 DATA SEND REBROADCAST: "), toSend);
 						
+		#if MW_SUPPORT_RANDOM_BACKOFF
+						//all neighbours got the FLOOD at the same time; don't rebroadcast in lockstep
+						Meshwork::Time::delay(nextRandom() % (m_backoffBase + 1));
+		#endif
+
 						MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_BEGIN(src, Wireless::Driver::BROADCAST, port, &recv_msg);
 
-						bool sent = sendWithoutACK(Wireless::Driver::BROADCAST, port, newMsg, dataLen, m_retry+1);
+						bool sent = sendWithoutACK(Wireless::Driver::BROADCAST, port, vp, m_retry+1);
 
 						MW_DECL_IF_SUPPORT_RADIO_LISTENER NOTIFY_SEND_END(src, Wireless::Driver::BROADCAST, port, &recv_msg, sent);
 
@@ -700,6 +2480,9 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 		}
 	}
 	MW_LOG_INFO(MW_LOG_NETWORKV1, "Receive result: %d", result);
+#if MW_SUPPORT_DUPLICATE_DETECTION
+	m_recentFrame = NULL;
+#endif
 	//reset abort flag before returning
 	m_sendAbort = false;
 	return result;
@@ -707,9 +2490,27 @@ Network::msg_l3_status_t Meshwork::L3::NetworkV1::NetworkV1::recv(uint8_t& src,
 
 bool Meshwork::L3::NetworkV1::NetworkV1::begin(const void* config) {
 	UNUSED(config);
+	if ( m_driver != NULL ) {
+		m_driver->get_capabilities(m_driverCaps);
+		if ( m_driverCaps.payload_max == 0 || m_driverCaps.payload_max > FRAME_MAX )
+			m_driverCaps.payload_max = FRAME_MAX;
+		MW_LOG_DEBUG(MW_LOG_NETWORKV1, "[Begin] Driver payload max=%d, broadcast=%d", m_driverCaps.payload_max, m_driverCaps.broadcast);
+	}
 	if ( m_advisor != NULL && m_driver != NULL ) {
 		m_advisor->set_address(m_driver->get_device_address());
 	}
+#if MW_SUPPORT_RANDOM_BACKOFF
+	//different per node, so that neighbours pick different backoffs
+	if ( m_driver != NULL )
+		m_random ^= ((uint32_t) m_driver->get_device_address() << 24) ^ RTC::micros();
+	if ( m_random == 0 )
+		m_random = 1;
+	//a restarted node must not reuse the seqs that the others still remember as recent frames
+	seq = (uint8_t) nextRandom();
+#else
+	uint32_t now = RTC::micros();
+	seq = (uint8_t) (now ^ (now >> 8) ^ (m_driver != NULL ? m_driver->get_device_address() : 0));
+#endif
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "[Begin] NwkID=%d, NodeID=%d, NwkKeyLen=%d, NwkKeyPtr=d", getNetworkID(), getNodeID(), getNetworkKeyLen(), getNetworkKey());
 	MW_LOG_DEBUG(MW_LOG_NETWORKV1, "[Begin] NwkChannel=%d, NwkCaps=%d, Delivery=%d", getChannel(), getNetworkCaps(), getDelivery());
 	return m_driver == NULL ? false : m_driver->begin();
@@ -37,6 +37,129 @@
 	#define MW_SUPPORT_RADIO_LISTENER	false
 #endif
 
+//The switches below that keep tables in RAM are on by default for the Mega only; an Uno has 2 KB SRAM.
+//Their costs are the growth of sizeof(NetworkV1) on the 64-bit Linux host; AVR pointers and padding are smaller
+
+//Drops retransmitted and multiply relayed frames; 80 bytes
+#ifndef MW_SUPPORT_DUPLICATE_DETECTION
+	#define MW_SUPPORT_DUPLICATE_DETECTION	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//Replays the cached ACK payload to retransmitted frames instead of asking the ACKProvider again;
+//96 bytes more in the duplicate detection table, so it follows MW_SUPPORT_DUPLICATE_DETECTION
+#ifndef MW_SUPPORT_ACK_REPLAY
+	#define MW_SUPPORT_ACK_REPLAY	MW_SUPPORT_DUPLICATE_DETECTION
+#endif
+#if MW_SUPPORT_ACK_REPLAY && !MW_SUPPORT_DUPLICATE_DETECTION
+	#error "MW_SUPPORT_ACK_REPLAY requires MW_SUPPORT_DUPLICATE_DETECTION"
+#endif
+
+//Queues frames received during an ACK wait for the next recv(); 144 bytes
+#ifndef MW_SUPPORT_RECV_QUEUE
+	#define MW_SUPPORT_RECV_QUEUE	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//Randomized exponential backoff between retries
+#ifndef MW_SUPPORT_RANDOM_BACKOFF
+	#define MW_SUPPORT_RANDOM_BACKOFF	true
+#endif
+
+//ACK timeouts from measured round-trip times instead of the constants alone; 64 bytes
+#ifndef MW_SUPPORT_ADAPTIVE_TIMEOUT
+	#define MW_SUPPORT_ADAPTIVE_TIMEOUT	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//Non-blocking send_async() driven by poll() and recv(); 416 bytes, mostly the pending table
+#ifndef MW_SUPPORT_ASYNC_SEND
+	#define MW_SUPPORT_ASYNC_SEND	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//Sends payloads above PAYLOAD_MAX as fragments, reassembled at the destination; 552 bytes for two reassembly buffers
+#ifndef MW_SUPPORT_FRAGMENTATION
+	#define MW_SUPPORT_FRAGMENTATION	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//ROUTED frames with the hop count in NWKCTRL and without breadcrumbs; off by default,
+//since nodes built without it misread such frames, so turn it on for the whole network
+#ifndef MW_SUPPORT_COMPACT_HEADER
+	#define MW_SUPPORT_COMPACT_HEADER	false
+#endif
+
+//Tries the delivery method and route that last worked for a destination first; 48 bytes
+#ifndef MW_SUPPORT_LAST_WORKING_ROUTE
+	#define MW_SUPPORT_LAST_WORKING_ROUTE	(MW_BOARD_SELECT == MW_BOARD_MEGA && MW_SUPPORT_DELIVERY_ROUTED)
+#endif
+#if MW_SUPPORT_LAST_WORKING_ROUTE && !MW_SUPPORT_DELIVERY_ROUTED
+	#error "MW_SUPPORT_LAST_WORKING_ROUTE requires MW_SUPPORT_DELIVERY_ROUTED"
+#endif
+
+//Skips the delivery methods that keep failing for a destination, with an occasional probe; 40 bytes
+#ifndef MW_SUPPORT_DELIVERY_PREDICTION
+	#define MW_SUPPORT_DELIVERY_PREDICTION	(MW_BOARD_SELECT == MW_BOARD_MEGA && MW_SUPPORT_DELIVERY_ROUTED)
+#endif
+#if MW_SUPPORT_DELIVERY_PREDICTION && !MW_SUPPORT_DELIVERY_ROUTED
+	#error "MW_SUPPORT_DELIVERY_PREDICTION requires MW_SUPPORT_DELIVERY_ROUTED"
+#endif
+
+//Tries the cached routes in the order of their expected transmission count (ETX), not slot order.
+//A node measures only its own links (MW_SUPPORT_NEIGHBOUR_TABLE), so the first link of a route counts
+//with its ETX and the further ones as perfect, while their losses show in the route's QoS;
+//no table of its own, 24 bytes of route order in the asynchronous send slots
+#ifndef MW_SUPPORT_ETX_ROUTING
+	#define MW_SUPPORT_ETX_ROUTING	MW_SUPPORT_DELIVERY_ROUTED
+#endif
+#if MW_SUPPORT_ETX_ROUTING && !MW_SUPPORT_DELIVERY_ROUTED
+	#error "MW_SUPPORT_ETX_ROUTING requires MW_SUPPORT_DELIVERY_ROUTED"
+#endif
+
+//Passes routes seen in relayed and received ROUTED and FLOOD frames to the RouteProvider
+#ifndef MW_SUPPORT_ROUTE_LEARNING
+	#define MW_SUPPORT_ROUTE_LEARNING	MW_SUPPORT_DELIVERY_ROUTED
+#endif
+#if MW_SUPPORT_ROUTE_LEARNING && !MW_SUPPORT_DELIVERY_ROUTED
+	#error "MW_SUPPORT_ROUTE_LEARNING requires MW_SUPPORT_DELIVERY_ROUTED"
+#endif
+
+//Keeps the routes of several FLOOD copies from one discovery, not just the first
+#ifndef MW_SUPPORT_MULTIPATH_DISCOVERY
+	#define MW_SUPPORT_MULTIPATH_DISCOVERY	MW_SUPPORT_DELIVERY_FLOOD
+#endif
+#if MW_SUPPORT_MULTIPATH_DISCOVERY && !(MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD)
+	#error "MW_SUPPORT_MULTIPATH_DISCOVERY requires MW_SUPPORT_DELIVERY_ROUTED and MW_SUPPORT_DELIVERY_FLOOD"
+#endif
+
+//Keeps link statistics of the directly heard nodes; 168 bytes
+#ifndef MW_SUPPORT_NEIGHBOUR_TABLE
+	#define MW_SUPPORT_NEIGHBOUR_TABLE	(MW_BOARD_SELECT == MW_BOARD_MEGA)
+#endif
+
+//Relays keep a ROUTED frame they failed to forward and retry it from poll() for a while; 88 bytes
+#ifndef MW_SUPPORT_HOP_RELIABLE
+	#define MW_SUPPORT_HOP_RELIABLE	(MW_BOARD_SELECT == MW_BOARD_MEGA && MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_REROUTING && MW_SUPPORT_ASYNC_SEND)
+#endif
+#if MW_SUPPORT_HOP_RELIABLE && !(MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_REROUTING && MW_SUPPORT_ASYNC_SEND)
+	#error "MW_SUPPORT_HOP_RELIABLE requires MW_SUPPORT_DELIVERY_ROUTED, MW_SUPPORT_REROUTING and MW_SUPPORT_ASYNC_SEND"
+#endif
+
+//Relays that cannot forward a ROUTED frame report the broken link back to the originator; off by
+//default, since an originator built without it takes the report for the ACK, so turn it on for the whole network
+#ifndef MW_SUPPORT_ROUTE_ERROR
+	#define MW_SUPPORT_ROUTE_ERROR	false
+#endif
+#if MW_SUPPORT_ROUTE_ERROR && !MW_SUPPORT_DELIVERY_ROUTED
+	#error "MW_SUPPORT_ROUTE_ERROR requires MW_SUPPORT_DELIVERY_ROUTED"
+#endif
+
+//Relays that cannot reach the next hop splice in a route of their own RouteProvider around it; off by
+//default, since nodes built without it misread the ROUTE_REPAIRED flag and drop the ACK over the new route,
+//so turn it on for the whole network
+#ifndef MW_SUPPORT_ROUTE_REPAIR
+	#define MW_SUPPORT_ROUTE_REPAIR	false
+#endif
+#if MW_SUPPORT_ROUTE_REPAIR && !(MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_REROUTING)
+	#error "MW_SUPPORT_ROUTE_REPAIR requires MW_SUPPORT_DELIVERY_ROUTED and MW_SUPPORT_REROUTING"
+#endif
+
 
  /*
  Payload structure:
@@ -74,6 +197,8 @@
  5) DELIVERY_ROUTED + ACK: Singlecast Only
  NWKID | DSTID	| DSTPORT | SEQ | DELIVERY_ROUTED + ACK		| ROUTE_INFO | (DataL3)
  NWKID | DSTID	| DSTPORT | SEQ | DELIVERY_ROUTED + ACK		| Node Count X | SRCID | Node 1 |  | Node X | DSTID | breadcrumbs Field | (DataL3)
+ Also the reply of the FLOOD destination, over the route the FLOOD has discovered.
+With MW_SUPPORT_MULTIPATH_DISCOVERY every copy of a discovery is answered this way.
  
  6) DELIVERY_FLOOD: Broadcast Only
  NWKID | 0xFF	| DSTPORT | SEQ | DELIVERY_FLOOD			| FLOOD_INFO | (DataL3)
@@ -81,6 +206,29 @@
  
  7) DELIVERY_FLOOD + ACK: Singlecast Only (used ONLY to enable fast fail of FLOOD sends)
  NWKID | DSTID	| DSTPORT | SEQ | DELIVERY_FLOOD + ACK		| <Empty>
+ 
+ 8) DELIVERY_DIRECT or DELIVERY_ROUTED + FRAGMENT: Singlecast Only
+ All fragments of a message share the SEQ. DataL3 starts with a fragment header:
+ ... | Index (+ FRAGMENT_ACK_REQUEST) | Fragment Count | Fragment Size | Data
+ Fragment Size is the data length of all but the last fragment.
+ Only the last fragment of each round requests an ACK. The destination ACKs with the
+ FRAGMENT flag and a bitmap of missing fragments (bit 0 of the first byte = fragment 0)
+ until the message is complete, then with a regular ACK.
+ 
+ 9) DELIVERY_ROUTED (+ ACK) with ROUTED_COMPACT: Singlecast Only
+ NWKID | DSTID	| DSTPORT | SEQ | ROUTED_COMPACT + Node Count X (+ ACK) (+ FRAGMENT) (+ ROUTE_REPAIRED) | SRCID | Node 1 |  | Node X | DSTID | (DataL3)
+ Node Count X takes the low three bits of NWKCTRL and replaces DELIVERY_ROUTED; there is no
+ breadcrumbs field. A node listed twice in the route drops the frame instead.
+ 
+ 10) DELIVERY_ROUTED + ACK + ROUTE_ERROR: Singlecast Only
+ NWKID | DSTID	| DSTPORT | SEQ | DELIVERY_ROUTED + ACK + ROUTE_ERROR | ROUTE_INFO | From ID | To ID
+ Sent by a relay that could not forward the ROUTED frame with this SEQ and route from From ID
+ to To ID. Travels back to SRCID like an ACK; also with ROUTED_COMPACT.
+ 
+ 11) DELIVERY_ROUTED (+ ACK) + ROUTE_REPAIRED: Singlecast Only
+ Same as 4) and 5). A relay that could not reach the next hop has replaced the rest of the route
+ with one of its own. The destination keeps the flag in the ACK, so that the originator takes
+ an ACK over a route other than the one it has sent.
 */
 
 namespace Meshwork {
@@ -109,6 +257,9 @@ namespace Meshwork {
 				  struct route_info_t {
 					route_t route;
 					uint8_t breadcrumbs;
+	#if MW_SUPPORT_COMPACT_HEADER
+					uint8_t compact;//compact NWKCTRL, filled in by get_iovec_msg_routed()
+	#endif
 				  };
 				  
 	#if MW_SUPPORT_DELIVERY_FLOOD
@@ -156,6 +307,18 @@ namespace Meshwork {
 				  typedef univmsg_any_t univmsg_t;
 				  
 #if MW_SUPPORT_DELIVERY_ROUTED
+				  //true if the route goes over the link a-b, in either direction
+				  static bool has_link(route_t* route, uint8_t a, uint8_t b) {
+					  uint8_t prev = route->src;
+					  for ( int i = 0; i <= route->hopCount; i ++ ) {
+						  uint8_t next = i < route->hopCount ? route->hops[i] : route->dst;
+						  if ( (prev == a && next == b) || (prev == b && next == a) )
+							  return true;
+						  prev = next;
+					  }
+					  return false;
+				  }
+
 				  class RouteProvider {
 				  public:
 					  //may invalidate cache, if any
@@ -164,6 +327,30 @@ namespace Meshwork {
 					  virtual route_t* get_route(uint8_t dst, uint8_t index) = 0;
 					  virtual void route_found(route_t* route) = 0;
 					  virtual void route_failed(route_t* route) = 0;
+					  //a route from this node taken from someone else's traffic; weaker evidence than route_found()
+					  virtual void route_learned(route_t* route) {
+						  UNUSED(route);
+					  }
+					  //a relay could not forward over the link from-to; routes using it in either direction are suspect.
+					  //Called during a send, so the indexes of get_route() should stay as they are
+					  virtual void link_failed(uint8_t from, uint8_t to) {
+						  UNUSED(from);
+						  UNUSED(to);
+					  }
+					  //QoS of the route at index, for ranking the routes; QOS_LEVEL_UNKNOWN if not kept
+					  virtual int8_t get_route_QoS(uint8_t dst, uint8_t index) {
+						  UNUSED(dst);
+						  UNUSED(index);
+						  return Network::QOS_LEVEL_UNKNOWN;
+					  }
+				  };
+#endif
+
+#if MW_SUPPORT_ASYNC_SEND
+				  class SendListener {
+				  public:
+					  //called once per send_async() handle; bufACK is only valid during the call
+					  virtual void send_completed(uint8_t handle, Network::msg_l3_status_t result, void* bufACK, size_t lenACK) = 0;
 				  };
 #endif
 
@@ -262,6 +449,22 @@ namespace Meshwork {
 				///////////// ROUTED  /////////////
 				static iovec_t* get_iovec_msg_routed(iovec_t* vec, univmsg_t* msg) {
 					iovec_t* vp = vec;
+	#if MW_SUPPORT_COMPACT_HEADER
+					if ( (msg->msg_routed.nwk_ctrl.delivery & DELIVERY_ROUTED) &&
+							msg->msg_routed.route_info.route.hopCount <= ROUTED_COMPACT_HOPS ) {
+						msg->msg_routed.route_info.compact = (msg->msg_routed.nwk_ctrl.delivery & (ACK | FRAGMENT | ROUTE_ERROR | ROUTE_REPAIRED)) |
+																ROUTED_COMPACT | msg->msg_routed.route_info.route.hopCount;
+						iovec_arg(vp, &msg->msg_routed.nwk_ctrl.seq, sizeof(msg->msg_routed.nwk_ctrl.seq));
+						iovec_arg(vp, &msg->msg_routed.route_info.compact, sizeof(msg->msg_routed.route_info.compact));
+						iovec_arg(vp, &msg->msg_routed.route_info.route.src, sizeof(msg->msg_routed.route_info.route.src));
+						if ( msg->msg_routed.route_info.route.hopCount > 0 )
+							iovec_arg(vp, msg->msg_routed.route_info.route.hops, msg->msg_routed.route_info.route.hopCount);
+						iovec_arg(vp, &msg->msg_routed.route_info.route.dst, sizeof(msg->msg_routed.route_info.route.dst));
+						iovec_arg(vp, msg->msg_routed.data, msg->msg_routed.dataLen);
+						iovec_end(vp);
+						return vec;
+					}
+	#endif
 					iovec_arg(vp, &msg->msg_routed.nwk_ctrl, sizeof(msg->msg_routed.nwk_ctrl));
 					iovec_arg(vp, &msg->msg_routed.route_info.route, sizeof(msg->msg_routed.route_info.route.hopCount)+sizeof(msg->msg_routed.route_info.route.src));
 					if ( msg->msg_routed.route_info.route.hopCount > 0 )
@@ -287,6 +490,39 @@ namespace Meshwork {
 					return msg;
 				}
 
+	#if MW_SUPPORT_COMPACT_HEADER
+				static univmsg_t* get_msg_routed_compact(univmsg_t* msg, uint8_t* data, int len) {
+					uint8_t hopCount = data[1] & ROUTED_COMPACT_HOPS;
+					msg->msg_routed.nwk_ctrl.seq = data[0];
+					if ( len < 4 + hopCount ) {
+						//truncated; without a delivery method it is taken for neither a message nor an ACK
+						msg->msg_routed.nwk_ctrl.delivery = 0;
+						msg->msg_routed.route_info.route.hopCount = 0;
+						msg->msg_routed.route_info.route.hops = NULL;
+						return msg;
+					}
+					msg->msg_routed.nwk_ctrl.delivery = DELIVERY_ROUTED | (data[1] & (ACK | FRAGMENT | ROUTE_ERROR | ROUTE_REPAIRED));
+					msg->msg_routed.route_info.route.hopCount = hopCount;
+					msg->msg_routed.route_info.route.src = data[2];
+					msg->msg_routed.route_info.route.hops = hopCount == 0 ? NULL : data + 3;
+					msg->msg_routed.route_info.route.dst = data[3 + hopCount];
+					msg->msg_routed.route_info.breadcrumbs = 0;
+					msg->msg_routed.route_info.compact = data[1];
+					msg->msg_routed.dataLen = len - 4 - hopCount;
+					msg->msg_routed.data = data + 4 + hopCount;
+					return msg;
+				}
+	#endif
+
+				//a ROUTED frame with either header; unlike get_msg() it fills in msg in any case
+				static univmsg_t* get_msg_routed_any(univmsg_t* msg, uint8_t* data, int len) {
+	#if MW_SUPPORT_COMPACT_HEADER
+					if ( data[1] & ROUTED_COMPACT )
+						return get_msg_routed_compact(msg, data, len);
+	#endif
+					return get_msg_routed(msg, data, len);
+				}
+
 				static uint8_t get_msg_routed_hop_index(univmsg_t* msg, uint8_t id) {
 					uint8_t result = -1;
 					for ( int i = 0; i < msg->msg_routed.route_info.route.hopCount; i ++ )
@@ -296,6 +532,11 @@ namespace Meshwork {
 						}
 					return result;
 				}
+
+				static bool is_same_route(route_t* a, route_t* b) {
+					return a->dst == b->dst && a->hopCount == b->hopCount &&
+							(a->hopCount == 0 || memcmp(a->hops, b->hops, a->hopCount) == 0);
+				}
 				
 	#if MW_SUPPORT_DELIVERY_FLOOD
 				///////////// FLOOD /////////////	
@@ -353,6 +594,12 @@ namespace Meshwork {
 				}
 				
 				static univmsg_t* get_msg(univmsg_t* msg, uint8_t* data, int len) {
+#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_COMPACT_HEADER
+					//first, the hop count overlaps the delivery bits
+					if ( data[1] & ROUTED_COMPACT )
+						return get_msg_routed_compact(msg, data, len);
+					else
+#endif
 					if ( data[1] & DELIVERY_DIRECT )
 						return get_msg_direct(msg, data, len);
 #if MW_SUPPORT_DELIVERY_ROUTED
@@ -393,6 +640,25 @@ namespace Meshwork {
 #endif
 					return 0;
 				}
+
+				static void set_msg_payload(univmsg_t* msg, uint8_t* data, uint8_t len) {
+					if ( msg->nwk_ctrl.delivery & DELIVERY_DIRECT ) {
+						msg->msg_direct.data = data;
+						msg->msg_direct.dataLen = len;
+					}
+#if MW_SUPPORT_DELIVERY_ROUTED
+					else if ( msg->nwk_ctrl.delivery & DELIVERY_ROUTED ) {
+						msg->msg_routed.data = data;
+						msg->msg_routed.dataLen = len;
+					}
+	#if MW_SUPPORT_DELIVERY_FLOOD
+					else if ( msg->nwk_ctrl.delivery & DELIVERY_FLOOD ) {
+						msg->msg_flood.data = data;
+						msg->msg_flood.dataLen = len;
+					}
+	#endif
+#endif
+				}
 				
 			protected:
 
@@ -405,6 +671,36 @@ namespace Meshwork {
 				RadioListener* m_radio_listener;
 #endif
 
+				//queried in begin(); payload_max is capped at FRAME_MAX, which the buffers are sized for
+				Wireless::Driver::capabilities_t m_driverCaps;
+
+#if MW_SUPPORT_RANDOM_BACKOFF
+				uint16_t m_backoffBase;
+				uint16_t m_backoffMax;
+				uint8_t m_backoffJitter;
+				uint32_t m_random;
+
+				uint32_t nextRandom();
+#endif
+				//wait before the given retry (0 = first); RETRY_WAIT_DIRECT without MW_SUPPORT_RANDOM_BACKOFF
+				uint16_t getBackoff(uint8_t retry);
+
+				//key of the ACK round trip of msg; false if not measured, as for FLOOD discovery
+				bool getRTTKey(univmsg_t* msg, uint8_t dest, uint8_t& dst, uint8_t& hopCount);
+				//first attempt's ACK timeout for msg, never above upper
+				uint32_t getACKTimeout(univmsg_t* msg, uint8_t dest, uint32_t upper);
+				void updateRTT(univmsg_t* msg, uint8_t dest, uint32_t rtt);
+
+				//copies a received payload to the caller's buffer; false if it does not fit
+				bool copyPayload(void* newData, size_t& newDataLenMax, const void* data, uint8_t len);
+
+				//next frame from the receive queue or the driver; keeps async sends going while waiting
+				int recvFrame(uint8_t& src, uint8_t& port, bool& broadcast, uint8_t* data, uint32_t ms);
+
+				//returns the ACK payload for the received frame, replayed from the cache if already ACKed
+				uint8_t getACKPayload(Meshwork::L3::Network::ACKProvider* ackProvider,
+									uint8_t origin, uint8_t hopPort, void* data, uint8_t dataLen, void* bufACK);
+
 				bool sendWithoutACK(uint8_t dest, uint8_t hopPort, iovec_t* vp, uint8_t attempts);
 				bool sendWithoutACK(uint8_t dest, uint8_t hopPort, const void* buf, size_t len, uint8_t attempts);
 
@@ -418,29 +714,69 @@ namespace Meshwork {
 #endif
 					);
 
+				//sends buf with sendWithACK(), or as fragments if it does not fit a frame
+				Network::msg_l3_status_t sendPayload(uint8_t attempts, uint16_t attemptsDelay,
+					uint8_t ack, uint32_t ackTimeout,
+					uint8_t dest, uint8_t port,
+					univmsg_t* msg, const void* buf, size_t len,
+					void* bufACK, size_t& maxACKLen);
+
+				//a non-NULL ack is sent as the ACK payload instead of asking the ACKProvider; flags are added to the delivery
 #if MW_SUPPORT_DELIVERY_ROUTED
 				Network::msg_l3_status_t sendRoutedACK(Meshwork::L3::Network::ACKProvider* ackProvider,
-									univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort);
+									univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort,
+									uint8_t flags = 0, const void* ack = NULL, uint8_t ackLen = 0);
 #endif
 				Network::msg_l3_status_t sendDirectACK(Meshwork::L3::Network::ACKProvider* ackProvider,
-									univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort);
+									univmsg_t* msg, uint8_t hopSrc, uint8_t hopPort,
+									uint8_t flags = 0, const void* ack = NULL, uint8_t ackLen = 0);
 
 			public:
-				/** The maximum payload length. */
+				/** The maximum payload length of a frame over any route; see get_payload_max() for the actual one. */
 				static const uint8_t PAYLOAD_MAX = 16;
 				/** The maximum ACK payload length. */
 				static const uint8_t ACK_PAYLOAD_MAX = 8;
+#if MW_SUPPORT_ACK_REPLAY
+				/** Marks a remembered frame whose ACK payload is not cached yet. */
+				static const uint8_t ACK_NOT_CACHED = 0xFF;
+#endif
+				/** The maximum L2 frame length incl. network header and route; same as NRF24L01P::PAYLOAD_MAX. */
+				static const uint8_t FRAME_MAX = 30;
+				/** The maximum payload length of a DIRECT frame; receive buffers of this size take any single frame. */
+				static const uint8_t FRAME_PAYLOAD_MAX = FRAME_MAX - sizeof(nwk_ctrl_t);
 				/** Default value for additional send retries. */
 				static const uint8_t DEFAULT_SEND_RETRY = 2;
 
 				/** Network Control byte's ACK flag. */
 				static const uint8_t ACK = 128;
+				/** Network Control byte's flag for fragments and their ACKs. */
+				static const uint8_t FRAGMENT = 64;
+				/** Network Control byte's flag for the compact ROUTED header. */
+				static const uint8_t ROUTED_COMPACT = 32;
+				/** Network Control byte's flag for a relay's report of a broken link; set with ACK. */
+				static const uint8_t ROUTE_ERROR = 16;
+				/** Network Control byte's flag for a route changed by a relay on the way; kept in the ACK. */
+				static const uint8_t ROUTE_REPAIRED = 8;
+				/** Mask of the hop count in a compact Network Control byte; also the longest compact route. */
+				static const uint8_t ROUTED_COMPACT_HOPS = 7;
 				/** Timeout for single ACK receive when sending. */
 				static const uint16_t TIMEOUT_ACK_RECEIVE = (uint16_t) 500;
 				/** Maximum timeout for DIRECT ACK when sending, including retries. */
 				static const uint16_t TIMEOUT_ACK_DIRECT = (uint16_t) TIMEOUT_ACK_RECEIVE * (DEFAULT_SEND_RETRY + 1);
 				/** Wait period before DIRECT delivery retry. */
 				static const uint16_t RETRY_WAIT_DIRECT = (uint16_t) TIMEOUT_ACK_RECEIVE;
+#if MW_SUPPORT_RANDOM_BACKOFF
+				/** Default backoff before the first retry. */
+				static const uint16_t BACKOFF_BASE = (uint16_t) 125;
+				/** Default cap for the doubling backoff. */
+				static const uint16_t BACKOFF_MAX = (uint16_t) 1000;
+				/** Default randomized share of the backoff, in percent. */
+				static const uint8_t BACKOFF_JITTER = 50;
+#endif
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+				/** Lower bound for an ACK timeout derived from measured round trips. */
+				static const uint16_t TIMEOUT_ACK_MIN = (uint16_t) 100;
+#endif
 				
 #if MW_SUPPORT_DELIVERY_ROUTED
 				/** Maximum routing hops for this network design. */
@@ -456,10 +792,46 @@ namespace Meshwork {
 				static const uint32_t TIMEOUT_ACK_FLOOD = (uint16_t) TIMEOUT_ACK_DIRECT * (MAX_ROUTING_HOPS + 2); //extra 2 spare cycles, just in case
 				/** Wait period before FLOOD delivery retry. */
 				static const uint32_t RETRY_WAIT_FLOOD = (uint16_t) TIMEOUT_ACK_RECEIVE;
+		#if MW_SUPPORT_MULTIPATH_DISCOVERY
+				/** Default limit of the time to collect more routes after the first FLOOD discovery reply. */
+				static const uint16_t TIMEOUT_DISCOVERY_COLLECT = (uint16_t) 250;
+		#endif
+		#if MW_SUPPORT_HOP_RELIABLE
+				/** Default time a relay keeps retrying a frame it failed to forward. */
+				static const uint16_t TIMEOUT_RELAY_RETRY = (uint16_t) TIMEOUT_ACK_DIRECT;
+		#endif
 
 	#endif
 #endif
 
+#if MW_SUPPORT_FRAGMENTATION
+				/** Fragment header length: index, count and size. */
+				static const uint8_t FRAGMENT_HEADER_SIZE = 3;
+				/** Set in the fragment index byte of the fragment that requests an ACK. */
+				static const uint8_t FRAGMENT_ACK_REQUEST = 0x80;
+				/** Payload carried by one fragment over any route; shorter routes carry more. */
+				static const uint8_t FRAGMENT_PAYLOAD_MAX = PAYLOAD_MAX - FRAGMENT_HEADER_SIZE;
+				/** Fragments per message; a whole message still fits the ACKProvider's uint8_t length. */
+				static const uint8_t MAX_FRAGMENTS = 255 / FRAGMENT_PAYLOAD_MAX;
+				/** The maximum payload length of a fragmented message. */
+				static const uint8_t MESSAGE_MAX = FRAGMENT_PAYLOAD_MAX * MAX_FRAGMENTS;
+				/** Time an incomplete message is kept without new fragments, and a completed one is remembered. */
+				static const uint32_t TIMEOUT_REASSEMBLY = (uint32_t) 15000;
+#endif
+				/** The maximum payload length delivered by recv(); receive buffers of this size take any message. */
+#if MW_SUPPORT_FRAGMENTATION
+				static const uint8_t RECV_PAYLOAD_MAX = MESSAGE_MAX;
+#else
+				static const uint8_t RECV_PAYLOAD_MAX = FRAME_PAYLOAD_MAX;
+#endif
+
+#if MW_SUPPORT_DUPLICATE_DETECTION
+				/** Time a delivered frame is remembered; covers all send retries of the originator. */
+				static const uint32_t TIMEOUT_RECENT_FRAME = (uint32_t) 60000;
+				/** Time a FLOOD frame is remembered; short enough not to block the originator's FLOOD retry. */
+				static const uint32_t TIMEOUT_RECENT_FLOOD = (uint32_t) TIMEOUT_ACK_DIRECT;
+#endif
+
 				NetworkV1(Wireless::Driver* driver,
 #if MW_SUPPORT_DELIVERY_ROUTED
 						RouteProvider* advisor = NULL,
@@ -475,8 +847,72 @@ namespace Meshwork {
 							, m_advisor(advisor),
 							m_maxHops(maxHops)
 #endif
-
-									{ seq = 0; };
+#if MW_SUPPORT_RANDOM_BACKOFF
+							, m_backoffBase(BACKOFF_BASE),
+							m_backoffMax(BACKOFF_MAX),
+							m_backoffJitter(BACKOFF_JITTER),
+							m_random(0x9E3779B9UL)
+#endif
+#if MW_SUPPORT_DUPLICATE_DETECTION
+							, m_recentFramesNext(0),
+							m_recentFrame(NULL)
+#endif
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+							, m_rttNodesNext(0)
+#endif
+#if MW_SUPPORT_RECV_QUEUE
+							, m_recvQueueHead(0),
+							m_recvQueueCount(0)
+#endif
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+							, m_lastRoutesNext(0)
+#endif
+#if MW_SUPPORT_DELIVERY_PREDICTION
+							, m_deliveryStatsNext(0)
+#endif
+#if MW_SUPPORT_MULTIPATH_DISCOVERY
+							, m_discoveryWindow(TIMEOUT_DISCOVERY_COLLECT)
+#endif
+#if MW_SUPPORT_HOP_RELIABLE
+							, m_relayWindow(TIMEOUT_RELAY_RETRY)
+#endif
+									{
+										seq = 0;
+										m_driverCaps.payload_max = FRAME_MAX;
+										m_driverCaps.broadcast = true;
+										m_driverCaps.rssi = false;
+										m_driverCaps.lqi = false;
+										m_driverCaps.retransmits = false;
+#if MW_SUPPORT_DUPLICATE_DETECTION
+										memset(m_recentFrames, 0, sizeof(m_recentFrames));
+#endif
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+										memset(m_rttHops, 0, sizeof(m_rttHops));
+										memset(m_rttNodes, 0, sizeof(m_rttNodes));
+#endif
+#if MW_SUPPORT_FRAGMENTATION
+										memset(m_reassembly, 0, sizeof(m_reassembly));
+#endif
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+										memset(m_lastRoutes, 0, sizeof(m_lastRoutes));
+	#if MW_SUPPORT_ROUTE_REPAIR
+										m_routeRepaired = false;
+	#endif
+#endif
+#if MW_SUPPORT_DELIVERY_PREDICTION
+										memset(m_deliveryStats, 0, sizeof(m_deliveryStats));
+#endif
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+										clear_neighbours();
+#endif
+#if MW_SUPPORT_ASYNC_SEND
+										for ( int i = 0; i < MAX_PENDING_SENDS; i ++ )
+											m_pending[i].state = PENDING_NONE;
+#endif
+#if MW_SUPPORT_HOP_RELIABLE
+										memset(m_relayFrames, 0, sizeof(m_relayFrames));
+#endif
+									};
 				
 #if MW_SUPPORT_DELIVERY_ROUTED
 				RouteProvider* get_route_advisor() {
@@ -506,6 +942,376 @@ namespace Meshwork {
 				Network::msg_l3_status_t recv(uint8_t& src, uint8_t& port, void* data, size_t& dataLenMax,
 						uint32_t ms, Meshwork::L3::Network::ACKProvider* ackProvider);
 
+				//backoff before retry n is base * 2^n up to max, of which jitter percent is random
+				void set_backoff(uint16_t base, uint16_t max, uint8_t jitter);
+
+#if MW_SUPPORT_MULTIPATH_DISCOVERY
+				//limit of the time to collect more routes after the first FLOOD discovery reply, which is
+				//also kept within twice the discovery round trip; 0 keeps the first route only
+				void set_discovery_window(uint16_t ms) {
+					m_discoveryWindow = ms;
+				}
+#endif
+
+#if MW_SUPPORT_HOP_RELIABLE
+				//time a relay keeps retrying a ROUTED frame the next hop has not acknowledged; 0 drops it right away
+				void set_relay_window(uint16_t ms) {
+					m_relayWindow = ms;
+				}
+#endif
+
+				//largest payload of a single DIRECT frame, or of a ROUTED one over hopCount hops, on this driver
+				uint8_t get_payload_max(uint8_t delivery = DELIVERY_DIRECT, uint8_t hopCount = 0);
+
+				const Wireless::Driver::capabilities_t& get_driver_capabilities() {
+					return m_driverCaps;
+				}
+
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+				/** Number of directly heard nodes with link statistics; RAM only. */
+				static const uint8_t MAX_NEIGHBOURS = 8;
+
+				struct neighbour_t {
+					uint8_t address;//0 if unused
+					uint32_t lastHeard;//RTC::millis() of the last frame from it, or of its hardware ACK
+					uint16_t received;//frames received from it
+					uint16_t sent;//unicast frames it has acknowledged
+					uint16_t failed;//unicast frames it has not acknowledged
+					uint16_t retransmits;//hardware retransmissions of the above, if the driver counts them
+					int8_t rssi;//input power level of the last frame from it, dBm; 0 if the driver does not measure it
+				};
+
+				//link statistics of a directly heard node; NULL if unknown
+				neighbour_t* get_neighbour(uint8_t address) {
+					return getNeighbour(address, false);
+				}
+
+				//entry index of the table, NULL if unused; for iterating up to MAX_NEIGHBOURS
+				neighbour_t* get_neighbour_at(uint8_t index) {
+					return index < MAX_NEIGHBOURS && m_neighbours[index].address != 0 ? &m_neighbours[index] : NULL;
+				}
+
+				uint8_t get_neighbour_count();
+
+				void clear_neighbours() {
+					memset(m_neighbours, 0, sizeof(m_neighbours));
+				}
+#endif
+
+#if MW_SUPPORT_ASYNC_SEND
+				//starts a send and returns immediately; the payload is copied, so buf may be reused.
+				//The outcome is reported to the listener from poll() or recv(), which also relay other
+				//nodes' traffic meanwhile. Returns OK and the handle if the send has been started
+				Network::msg_l3_status_t send_async(uint8_t delivery, uint8_t retry,
+									uint8_t dest, uint8_t port,
+									const void* buf, size_t len,
+									SendListener* listener, uint8_t& handle);
+
+				//drives pending asynchronous sends; recv() calls it while waiting for frames
+				void poll();
+
+				//number of asynchronous sends still waiting for completion
+				uint8_t get_pending_count();
+#endif
+
+			protected:
+#if MW_SUPPORT_DUPLICATE_DETECTION
+				/** Number of recently received frames remembered for duplicate detection. */
+				static const uint8_t MAX_RECENT_FRAMES = 8;
+
+				struct recent_frame_t {
+					uint8_t origin;//0 if unused
+					uint8_t port;
+					uint8_t seq;
+					bool flood;
+					uint32_t time;
+	#if MW_SUPPORT_ACK_REPLAY
+					uint8_t ackLen;//ACK_NOT_CACHED until the first ACK is sent
+					uint8_t ack[ACK_PAYLOAD_MAX];
+	#endif
+				};
+				recent_frame_t m_recentFrames[MAX_RECENT_FRAMES];
+				uint8_t m_recentFramesNext;
+				//entry of the frame last checked by isDuplicate(); NULL outside recv()
+				recent_frame_t* m_recentFrame;
+
+				//returns true if the frame has been seen recently, otherwise remembers it
+				bool isDuplicate(uint8_t origin, uint8_t port, uint8_t seq, bool flood);
+#endif
+
+#if MW_SUPPORT_ADAPTIVE_TIMEOUT
+				/** Number of destinations with their own round-trip estimate. */
+				static const uint8_t MAX_RTT_NODES = 4;
+	#if MW_SUPPORT_DELIVERY_ROUTED && MW_SUPPORT_DELIVERY_FLOOD
+				/** Hop count that FLOOD discovery round trips are kept under, past the longest route. */
+				static const uint8_t RTT_HOPS_FLOOD = MAX_ROUTING_HOPS + 1;
+				static const uint8_t MAX_RTT_HOPS = RTT_HOPS_FLOOD + 1;
+	#elif MW_SUPPORT_DELIVERY_ROUTED
+				static const uint8_t MAX_RTT_HOPS = MAX_ROUTING_HOPS + 1;
+	#else
+				static const uint8_t MAX_RTT_HOPS = 1;
+	#endif
+
+				struct rtt_estimate_t {
+					uint16_t srtt;//ms, 0 if no samples yet
+					uint16_t rttvar;
+				};
+				struct rtt_node_t {
+					uint8_t dst;//0 if unused
+					uint8_t hopCount;
+					rtt_estimate_t rtt;
+				};
+				//per hop count, used for destinations without an own estimate
+				rtt_estimate_t m_rttHops[MAX_RTT_HOPS];
+				rtt_node_t m_rttNodes[MAX_RTT_NODES];
+				uint8_t m_rttNodesNext;
+
+				static void updateRTTEstimate(rtt_estimate_t* est, uint32_t rtt);
+#endif
+
+#if MW_SUPPORT_RECV_QUEUE
+				/** Number of frames kept for the next recv() while waiting for an ACK. */
+				static const uint8_t MAX_QUEUED_FRAMES = 4;
+
+				struct queued_frame_t {
+					uint8_t src;
+					uint8_t port;
+					bool broadcast;
+					uint8_t len;
+					uint8_t data[FRAME_MAX];
+				};
+				queued_frame_t m_recvQueue[MAX_QUEUED_FRAMES];
+				uint8_t m_recvQueueHead;
+				uint8_t m_recvQueueCount;
+
+				void queueFrame(uint8_t src, uint8_t port, bool broadcast, uint8_t* data, uint8_t len);
+#endif
+
+#if MW_SUPPORT_LAST_WORKING_ROUTE
+				/** Number of destinations whose last working delivery is remembered; RAM only. */
+				static const uint8_t MAX_LAST_ROUTES = 4;
+
+				struct last_route_t {
+					uint8_t dst;//0 if unused
+					uint8_t delivery;//DELIVERY_DIRECT or DELIVERY_ROUTED
+					uint8_t hopCount;
+					uint8_t hops[MAX_ROUTING_HOPS];
+				};
+				last_route_t m_lastRoutes[MAX_LAST_ROUTES];
+				uint8_t m_lastRoutesNext;
+
+				last_route_t* getLastRoute(uint8_t dst);
+				//remembers a successful send to dst; route is NULL for DIRECT
+				void setLastRoute(uint8_t dst, route_t* route);
+				void clearLastRoute(uint8_t dst);
+#endif
+
+#if MW_SUPPORT_DELIVERY_PREDICTION
+				/** Number of destinations with delivery statistics; RAM only. */
+				static const uint8_t MAX_DELIVERY_STATS = 8;
+				/** Consecutive failures after which a delivery method is skipped for a destination. */
+				static const uint8_t PREDICT_FAIL_STREAK = 2;
+				/** A skipped delivery method is tried again on every this many sends. */
+				static const uint8_t PREDICT_PROBE_INTERVAL = 8;
+
+				struct delivery_stats_t {
+					uint8_t dst;//0 if unused
+					uint8_t directFails;//consecutive failed DIRECT sends
+					uint8_t routedFails;//consecutive sends that failed over all known routes
+					uint8_t skipped;//sends since the last probe of a skipped method
+				};
+				delivery_stats_t m_deliveryStats[MAX_DELIVERY_STATS];
+				uint8_t m_deliveryStatsNext;
+
+				delivery_stats_t* getDeliveryStats(uint8_t dst, bool create);
+				//the delivery mask without the methods that keep failing for dst
+				uint8_t predictDelivery(uint8_t dst, uint8_t delivery);
+				//records the outcome of a DIRECT or ROUTED send to dst
+				void updateDeliveryStats(uint8_t dst, uint8_t delivery, bool ok);
+				//a frame from src has reached us directly
+				void heardDirect(uint8_t src);
+#endif
+
+#if MW_SUPPORT_ETX_ROUTING
+				/** Fixed point unit of the expected transmission count (ETX). */
+				static const uint16_t ETX_UNIT = 16;
+				/** Largest ETX of a single link. */
+				static const uint16_t ETX_LINK_MAX = 64 * ETX_UNIT;
+				/** Number of routes per destination that are ranked and tried. */
+				static const uint8_t MAX_RANKED_ROUTES = 8;
+
+				//expected transmissions over the link to a neighbour; 1 unless the neighbour table has measured it
+				uint16_t getLinkETX(uint8_t neighbour);
+				//ETX of our link to the first hop plus one per further link, whose ETX we cannot know,
+				//plus one per failure of the route beyond its successes (QoS)
+				uint16_t getRouteETX(route_t* route, int8_t qos);
+				//fills order and cost with the route indices of dst and their ETX, cheapest first; returns their number
+				uint8_t rankRoutes(uint8_t dst, uint8_t* order, uint16_t* cost);
+#endif
+
+#if MW_SUPPORT_NEIGHBOUR_TABLE
+				//counters halve together when one is full, so the ratios follow recent traffic
+				neighbour_t m_neighbours[MAX_NEIGHBOURS];
+
+				//with create, a missing entry replaces an unused or the least recently heard one
+				neighbour_t* getNeighbour(uint8_t address, bool create);
+				//the driver has received a frame from src; call right away for the power level
+				void neighbourHeard(uint8_t src);
+				//the driver has sent a unicast frame to dest
+				void neighbourSent(uint8_t dest, bool acked);
+#endif
+
+#if MW_SUPPORT_ROUTE_LEARNING
+				//passes the part of a received route between us and its src (reverse) or dst to the RouteProvider;
+				//myHop is our position in src, hops, dst
+				void learnRoute(route_t* route, uint8_t myHop, bool reverse);
+#endif
+
+#if MW_SUPPORT_DELIVERY_FLOOD
+				//when sendWithACK() sent its last attempt; the FLOOD discovery round trip is taken from there
+				uint32_t m_lastAttempt;
+#endif
+
+#if MW_SUPPORT_MULTIPATH_DISCOVERY
+				/** Number of routes kept from one FLOOD discovery. */
+				static const uint8_t MAX_DISCOVERED_ROUTES = 3;
+
+				struct discovered_route_t {
+					uint8_t hopCount;
+					uint8_t hops[MAX_ROUTING_HOPS];
+				};
+				uint16_t m_discoveryWindow;
+
+				//receives the other discovery replies for the seq for up to window ms; returns the number of routes, best first
+				uint8_t collectRoutes(uint8_t port, uint8_t seq, uint8_t dest, uint32_t window, discovered_route_t* routes, uint8_t count);
+				//ranks by hop count, then arrival; returns the new number of routes
+				static uint8_t addDiscoveredRoute(discovered_route_t* routes, uint8_t count, route_t* route);
+#endif
+
+#if MW_SUPPORT_ASYNC_SEND
+				/** Maximum number of asynchronous sends in flight; more ACKs than the radio's RX FIFO (3 on NRF24L01P) would be dropped.
+				 * Each slot keeps a copy of the payload and route, 136 bytes on the host. */
+				static const uint8_t MAX_PENDING_SENDS = 3;
+
+				static const uint8_t PENDING_NONE = 0;
+				static const uint8_t PENDING_ACTIVE = 1;
+				static const uint8_t PENDING_WAIT_ACK = 2;
+				static const uint8_t PENDING_RETRY = 3;
+
+				struct pending_send_t {
+					uint8_t state;
+					uint8_t delivery;//delivery methods not tried yet
+					uint8_t count;//attempts per delivery method or route
+					uint8_t attempt;
+					uint8_t tries;//failed driver sends within the current attempt
+					uint8_t routeIndex;
+	#if MW_SUPPORT_ETX_ROUTING
+					uint8_t routeRanked;//number of routes in routeOrder
+					uint8_t routeOrder[MAX_RANKED_ROUTES];
+	#endif
+					uint8_t dest;
+					uint8_t port;
+					uint8_t len;
+					uint8_t handle;//the first seq; the ROUTED step of FLOOD takes another one
+					bool floodACK;//a neighbour has heard our FLOOD
+					Network::msg_l3_status_t result;
+					uint32_t time;//last transmission
+					uint32_t firstTime;//first attempt of the current delivery method or route
+					uint32_t timeout;//current attempt
+					uint32_t timeoutMax;
+					uint16_t wait;//before the next retry
+					SendListener* listener;
+					univmsg_t msg;
+					uint8_t data[PAYLOAD_MAX];
+	#if MW_SUPPORT_DELIVERY_ROUTED
+					uint8_t hops[MAX_ROUTING_HOPS];
+	#endif
+				};
+				pending_send_t m_pending[MAX_PENDING_SENDS];
+
+				//prepares the next delivery method or route; false if none is left
+				bool nextPendingStep(pending_send_t* p);
+				bool transmitPending(pending_send_t* p);
+				void pollPending(pending_send_t* p);
+				void completePending(pending_send_t* p, Network::msg_l3_status_t result, void* bufACK, size_t lenACK);
+				//true if the received frame is an ACK for the pending send and has been consumed
+				bool handlePendingACK(uint8_t src, uint8_t port, univmsg_t* reply, uint8_t len);
+				bool handlePendingACK(pending_send_t* p, uint8_t src, uint8_t port, univmsg_t* reply, uint8_t len);
+				//ms until the next pending send deadline, 0 if nothing is pending
+				uint32_t getPollTimeout();
+#endif
+
+#if MW_SUPPORT_HOP_RELIABLE
+				/** Number of frames a relay keeps for retrying at the same time. */
+				static const uint8_t MAX_RELAY_FRAMES = 2;
+
+				struct relay_frame_t {
+					uint8_t len;//0 if unused
+					uint8_t dest;
+					uint8_t port;
+					uint8_t tries;
+					uint32_t firstTime;//first failed forward
+					uint32_t time;//last try
+					uint16_t wait;//before the next try
+					uint8_t data[FRAME_MAX];
+				};
+				relay_frame_t m_relayFrames[MAX_RELAY_FRAMES];
+				uint16_t m_relayWindow;
+
+				//keeps a frame the driver failed to forward; false if no slot is free
+				bool queueRelay(uint8_t dest, uint8_t port, const void* data, uint8_t len);
+				void pollRelay(relay_frame_t* r);
+#endif
+
+#if MW_SUPPORT_ROUTE_ERROR
+				//tells the previous hop of the ROUTED frame in data that we could not forward it to next
+				void sendRouteError(uint8_t port, uint8_t* data, uint8_t len, uint8_t next);
+				//marks the routes over the link named in a route error as failed
+				void routeBroken(univmsg_t* msg);
+#endif
+
+#if MW_SUPPORT_ROUTE_REPAIR
+				//forwards the ROUTED frame in data around next over a route of our own; false if there is none or the send fails
+				bool repairRoute(uint8_t port, uint8_t* data, uint8_t len, uint8_t next, uint8_t attempts);
+				//the ACK to sent has come over repaired
+				void routeRepaired(route_t* sent, route_t* repaired);
+	#if MW_SUPPORT_LAST_WORKING_ROUTE
+				//set when the last ACK came over a repaired route; setLastRoute() keeps that one then
+				bool m_routeRepaired;
+	#endif
+#endif
+
+#if MW_SUPPORT_FRAGMENTATION
+				/** Number of messages reassembled at the same time. */
+				static const uint8_t MAX_REASSEMBLY_BUFFERS = 2;
+				/** sendWithACK() result for a fragment ACK that lists missing fragments. */
+				static const int8_t OK_FRAGMENTS_MISSING = 5;
+
+				struct reassembly_t {
+					uint8_t origin;
+					uint8_t port;
+					uint8_t seq;
+					uint8_t count;//0 if unused
+					uint8_t size;//of all but the last fragment
+					uint32_t received;//bitmap
+					uint8_t len;
+					bool done;//delivered; kept to re-ACK retransmitted fragments
+					uint8_t ackLen;
+					uint8_t ack[ACK_PAYLOAD_MAX];
+					uint32_t time;//last fragment
+					uint8_t data[MESSAGE_MAX];
+				};
+				reassembly_t m_reassembly[MAX_REASSEMBLY_BUFFERS];
+
+				Network::msg_l3_status_t sendFragments(uint8_t attempts, uint16_t attemptsDelay, uint32_t ackTimeout,
+					uint8_t dest, uint8_t port, uint8_t size,
+					univmsg_t* msg, const void* buf, size_t len,
+					void* bufACK, size_t& maxACKLen);
+				Network::msg_l3_status_t recvFragment(uint8_t src, uint8_t port, univmsg_t* msg,
+					void* newData, size_t& newDataLenMax, Meshwork::L3::Network::ACKProvider* ackProvider);
+				//message the fragment belongs to; replaces a free, stale, completed or the oldest one
+				reassembly_t* getReassembly(uint8_t origin, uint8_t port, uint8_t seq, uint8_t count);
+#endif
 			};
 		};
 	};
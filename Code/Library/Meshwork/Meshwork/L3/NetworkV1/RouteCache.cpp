@@ -115,6 +115,20 @@ void RouteCache::remove_route_entry(route_entry_t* entry) {
 	}
 }
 				
+uint8_t RouteCache::fail_routes_with_link(uint8_t a, uint8_t b) {
+	uint8_t result = 0;
+	//entries keep their slots, so that the indexes of a send in progress stay valid
+	for ( int i = 0; i < MAX_DST_NODES; i ++ )
+		for ( int j = 0; j < MAX_DST_ROUTES; j ++ ) {
+			route_entry_t* entry = &m_table.lists[i].entries[j];
+			if ( entry->route.dst != 0 && NetworkV1::has_link(&entry->route, a, b) ) {
+				entry->qos = Network::QOS_LEVEL_MIN;
+				result ++;
+			}
+		}
+	return result;
+}
+
 RouteCache::route_entry_t* RouteCache::get_route_entry(uint8_t dst, uint8_t index) {
 	route_entry_t* result = NULL;
 	route_list_t* list = get_route_list(dst);
@@ -169,7 +183,7 @@ int8_t RouteCache::get_QoS(uint8_t dst, int8_t calculate) {
 		//set initial value
 		result = calculate == Network::QOS_CALCULATE_BEST ? Network::QOS_LEVEL_MIN :
 					(calculate == Network::QOS_CALCULATE_WORST ? Network::QOS_LEVEL_MAX : 0);
-		bool firstRoute = true;
+		int8_t count = 0;
 		//yes, this looks weird, but single loop makes the code smaller
 		MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "QoS for dst: %d, method: %d", dst, calculate);
 		if ( MW_LOG_ROUTECACHE )
@@ -186,12 +200,9 @@ int8_t RouteCache::get_QoS(uint8_t dst, int8_t calculate) {
 					case Network::QOS_CALCULATE_BEST: result = result < tmp ? tmp : result; break;
 					case Network::QOS_CALCULATE_WORST: result = result > tmp ? tmp : result; break;
 					case Network::QOS_CALCULATE_AVERAGE:
-						if ( firstRoute ) {
-							firstRoute = false;
-							result = tmp;
-						} else {
-							result = ((result + tmp) / 2);
-						}
+						//sum here, divide after the loop
+						result = count == 0 ? tmp : result + tmp;
+						count ++;
 						break;
 					default:
 						MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "Unknown method: %d", calculate);
@@ -199,11 +210,13 @@ int8_t RouteCache::get_QoS(uint8_t dst, int8_t calculate) {
 				}
 			}
 		}
+		if ( calculate == Network::QOS_CALCULATE_AVERAGE && count > 0 )
+			result = result / count;
 	}
 	return normalize_QoS(result);//normalize, just in case
 }
 				
-RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route, bool forceReplace) {
+RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route, bool forceReplace, int8_t initialQoS) {
 	route_entry_t* result = NULL;
 	if ( get_route_entry(route) == NULL ) {
 		MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** Route not in the cache. Force replace: %d", forceReplace);
@@ -211,7 +224,7 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 		route_list_t* list = get_route_list(dst);
 		if ( list != NULL ) {
 			MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** Route list exists for dst: %d", dst);
-			uint8_t worst = Network::QOS_LEVEL_MAX;
+			int8_t worst = Network::QOS_LEVEL_MAX;
 			uint8_t worstIndex = MAX_DST_ROUTES - 1;
 			//try to add to exising routes
 			for ( int i = 0; i < MAX_DST_ROUTES; i ++ ) {
@@ -220,8 +233,9 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 					MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** Empty slot found at: %d, Address: %d", dst, result);
 					break;
 				} else if ( forceReplace ) {
-					uint8_t qos = list->entries[i].qos;
-					if ( worst < qos ) {
+					//on equal QoS the later entry goes first
+					int8_t qos = list->entries[i].qos;
+					if ( qos <= worst ) {
 						worst = qos;
 						worstIndex = i;
 					}
@@ -235,7 +249,7 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 			}
 		} else {
 			MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** Route list doesn't exist for dst: %d", dst);
-			uint8_t worst = Network::QOS_LEVEL_MAX;
+			int8_t worst = Network::QOS_LEVEL_MAX;
 			uint8_t worstIndex = MAX_DST_NODES - 1;
 			//try to add a new node
 			for ( int i = 0; i < MAX_DST_NODES; i ++ )
@@ -247,8 +261,8 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 					MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** Found empty route slot at: %d, Address: %d", i, result);
 					break;
 				} else if ( forceReplace ) {
-					uint8_t qos = get_QoS(dst, Network::QOS_CALCULATE_AVERAGE);
-					if ( worst < qos ) {
+					int8_t qos = get_QoS(m_table.lists[i].dst, Network::QOS_CALCULATE_AVERAGE);
+					if ( qos <= worst ) {
 						worst = qos;
 						worstIndex = i;
 					}
@@ -257,13 +271,12 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 			//then choose the one with worst QoS
 			if ( result == NULL && forceReplace ) {
 				MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** No free slot. Replacing at: %d", worstIndex);
+				//clear all entries of the evicted dst
+				remove_all_for_dst(m_table.lists[worstIndex].dst);
 				//choose the first element
 				result = &m_table.lists[worstIndex].entries[0];
 				//mark the list as used by this dst
 				m_table.lists[worstIndex].dst = dst;
-				//clear other entries
-				for ( int i = 1; i < MAX_DST_ROUTES; i ++ )
-					m_table.lists[worstIndex].entries[i].route.dst = 0;
 			}
 		}
 		if ( result != NULL ) {
@@ -279,7 +292,7 @@ RouteCache::route_entry_t* RouteCache::add_route_entry(NetworkV1::route_t* route
 				memcpy(result->route.hops, route->hops, route->hopCount);
 			
 			result->route.dst = route->dst;
-			result->qos = Network::QOS_LEVEL_AVERAGE;
+			result->qos = normalize_QoS(initialQoS);
 			
 			MW_LOG_DEBUG(MW_LOG_ROUTECACHE, "*** New route data", NULL);
 			if ( MW_LOG_ROUTECACHE )
@@ -66,7 +66,7 @@ namespace Meshwork {
 				};
 			
 				struct route_list_t {
-					int8_t dst;
+					uint8_t dst;
 					route_entry_t entries[MAX_DST_ROUTES];
 				};
 				
@@ -74,8 +74,7 @@ namespace Meshwork {
 					route_list_t lists[MAX_DST_NODES];
 				};
 				
-				//TODO add Last Working Route per node - RAM only
-
+				//Last Working Route per node is kept in RAM by NetworkV1, see MW_SUPPORT_LAST_WORKING_ROUTE
 
 				class RouteCacheListener {
 				public:
@@ -113,7 +112,7 @@ namespace Meshwork {
 				};
 				
 
-				route_entry_t* add_route_entry(NetworkV1::route_t* route, bool forceReplace);
+				route_entry_t* add_route_entry(NetworkV1::route_t* route, bool forceReplace, int8_t initialQoS = Network::QOS_LEVEL_AVERAGE);
 				
 				
 				void remove_all();
@@ -122,6 +121,9 @@ namespace Meshwork {
 				
 				void remove_route_entry(route_entry_t* entry);
 				
+				//drops the routes over the link a-b in either direction to QOS_LEVEL_MIN; returns how many
+				uint8_t fail_routes_with_link(uint8_t a, uint8_t b);
+				
 				
 				uint8_t get_route_count(uint8_t dst);
 				
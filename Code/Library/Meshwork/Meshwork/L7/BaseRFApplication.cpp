@@ -132,10 +132,11 @@ int BaseRFApplication::returnACKPayload(uint8_t src, uint8_t port, void* buf, ui
 			return prepareACKPayload(&m_last_message, BASERF_CMD_ACK_STATUS_INVALID, NULL, 0, &bufACK, lenACK);
 		} else {
 			//4.c.1) else return
-			if ( handleCustomCommand(&m_last_message) == BASERF_CMD_ACK_STATUS_NOT_SUPPORTED ) {
+			int status = handleCustomCommand(&m_last_message);
+			if ( status == BASERF_CMD_ACK_STATUS_NOT_SUPPORTED ) {
 				MW_LOG_DEBUG_TRACE(MW_LOG_BASERF) << PSTR("NOT_SUPPORTED: ") << m_last_message.msg_header.cmd_id << endl;
-				return prepareACKPayload(&m_last_message, BASERF_CMD_ACK_STATUS_NOT_SUPPORTED, NULL, 0, &bufACK, lenACK);
 			}
+			return prepareACKPayload(&m_last_message, status, NULL, 0, &bufACK, lenACK);
 		}
 	}
 }
@@ -153,13 +154,15 @@ void BaseRFApplication::pollMessage(uint32_t poll_timeout) {
 	//1) receive a message
 
 	uint8_t src, port;
-	size_t dataLen = BASERF_MESSAGE_PAYLOAD_MAXLEN;
+	size_t dataLen;
 
 	uint32_t start = RTC::millis();
 	while (true) {
 		trace << endl;
 		setLastMessageValid(false);
 
+		//recv() sets the length of the message received
+		dataLen = sizeof(m_last_message_raw_data);
 		int result = m_network->recv(src, port, m_last_message_raw_data, dataLen, poll_timeout, this);
 		if ( result == Meshwork::L3::Network::OK &&
 				port == BASERF_MESSAGE_PORT &&
@@ -211,7 +214,7 @@ void BaseRFApplication::pollMessage() {
 
 #ifdef MW_SUPPORT_BASERF_SUPPORTED_META
 Network::msg_l3_status_t BaseRFApplication::sendMetaReportDevice(univmsg_l7_any_t* msg, uint8_t flags) {
-	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF);
+	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF) << PSTR("sendMetaReportDevice") << endl;
 
 	bool allClusters = flags & BASERF_CMD_METAFLAG_ALL_CLUSTERS;
 	uint8_t cluster_count = m_device->getClusterCount();
@@ -243,7 +246,7 @@ Network::msg_l3_status_t BaseRFApplication::sendMetaReportDevice(univmsg_l7_any_
 #ifdef MW_SUPPORT_BASERF_SUPPORTED_META
 Network::msg_l3_status_t BaseRFApplication::sendMetaReportCluster(univmsg_l7_any_t* msg, uint8_t flags, bool cmd_mc_last,
 		uint8_t clusterID) {
-	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF);
+	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF) << PSTR("sendMetaReportCluster") << endl;
 
 	bool allEndpoints = flags & BASERF_CMD_METAFLAG_ALL_ENDPOINTS;
 	bool allClusters = flags & BASERF_CMD_METAFLAG_ALL_CLUSTERS;
@@ -292,7 +295,7 @@ Network::msg_l3_status_t BaseRFApplication::sendMetaReportCluster(univmsg_l7_any
 #ifdef MW_SUPPORT_BASERF_SUPPORTED_META
 Network::msg_l3_status_t BaseRFApplication::sendMetaReportEndpoint(univmsg_l7_any_t* msg, uint8_t flags, bool cmd_mc_last,
 		uint8_t clusterID, uint8_t endpointID) {
-	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF);
+	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF) << PSTR("sendMetaReportEndpoint") << endl;
 
 	bool allEndpoints = flags & BASERF_CMD_METAFLAG_ALL_ENDPOINTS;
 	uint8_t nextEndpointID = allEndpoints ? 0 : endpointID;
@@ -357,7 +360,7 @@ msg_l7_ack_status_t BaseRFApplication::sendPropertySet(uint8_t nodeID, bool cmd_
 
 Network::msg_l3_status_t BaseRFApplication::sendPropertyReport(univmsg_l7_any_t* msg, bool cmd_mc_last,
 		uint8_t clusterID, uint8_t endpointID) {
-	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF);
+	MW_LOG_DEBUG_TRACE(MW_LOG_BASERF) << PSTR("sendPropertyReport") << endl;
 
 	//6.a.1) GET: create empty endpoint_value_t and call getProperty
 	Endpoint::endpoint_value_t value;
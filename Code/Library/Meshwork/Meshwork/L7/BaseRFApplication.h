@@ -190,7 +190,8 @@ namespace Meshwork {
 			uint16_t m_sent_report_count;
 			uint16_t m_recv_request_count;
 
-			uint8_t m_last_message_raw_data[BASERF_MESSAGE_PAYLOAD_MAXLEN];
+			//takes any message recv() may deliver; the longer ones than BASERF_MESSAGE_PAYLOAD_MAXLEN are ignored
+			uint8_t m_last_message_raw_data[Meshwork::L3::NetworkV1::NetworkV1::RECV_PAYLOAD_MAX];
 			univmsg_l7_any_t m_last_message;
 			bool m_last_message_valid;
 
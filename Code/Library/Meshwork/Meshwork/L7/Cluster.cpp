@@ -21,7 +21,9 @@
 #ifndef __MESHWORK_L7_CLUSTER_CPP__
 #define __MESHWORK_L7_CLUSTER_CPP__
 
+#include "Meshwork/L3/Network.h"
 #include "Meshwork/L7/Cluster.h"
+#include "Meshwork/L7/Endpoint.h"
 
 using namespace Meshwork::L7;
 using Meshwork::L3::Network;
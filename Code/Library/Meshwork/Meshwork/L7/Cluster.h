@@ -33,9 +33,9 @@ namespace Meshwork {
 
 	namespace L7 {
 
-//		class Endpoint;
-//
-//		class Device;
+		class Endpoint;
+
+		class Device;
 
 		class Cluster {
 
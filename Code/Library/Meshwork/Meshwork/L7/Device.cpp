@@ -21,6 +21,9 @@
 #ifndef __MESHWORK_L7_DEVICE_CPP__
 #define __MESHWORK_L7_DEVICE_CPP__
 
+#include "Meshwork/L3/Network.h"
+#include "Meshwork/L7/Endpoint.h"
+#include "Meshwork/L7/Cluster.h"
 #include "Meshwork/L7/Device.h"
 
 using namespace Meshwork::L7;
@@ -32,7 +32,7 @@ namespace Meshwork {
 
 	namespace L7 {
 
-//		class Cluster;
+		class Cluster;
 
 		class Endpoint {
 
@@ -131,7 +131,7 @@ uint8_t SerialMessageAdapter::processOneMessage(serialmsg_t* msg) {
 		if ( waitForBytes(msg->len - 3, m_timeout) ) {
 			SerialMessageListener* listener;
 
-			for ( int i = 0; i < (int) membersof(m_listeners); i ++ ) {
+			for ( int i = 0; i < m_listenersCount; i ++ ) {
 				listener = m_listeners[i];
 				result = listener->processOneMessage(m_currentMsg);
 
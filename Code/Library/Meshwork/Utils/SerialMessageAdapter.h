@@ -78,6 +78,7 @@ class SerialMessageAdapter {
 	protected:
 		UART* m_serial;
 		SerialMessageListener** m_listeners;
+		uint8_t m_listenersCount;
 		serialmsg_t* m_currentMsg;
 		uint8_t m_lastSerialMsgLen;
 		uint8_t m_timeout;
@@ -86,14 +87,17 @@ class SerialMessageAdapter {
 		SerialMessageAdapter(UART* serial, uint16_t timeout = TIMEOUT_RESPONSE):
 			m_serial(serial),
 			m_listeners(NULL),
+			m_listenersCount(0),
 			m_currentMsg(NULL),
 			m_lastSerialMsgLen(0),
 			m_timeout(timeout)
 		{
 		};
 
-		void setListeners(SerialMessageListener* listeners[]) {
+		//count is the length of the listeners array, e.g. membersof(listeners)
+		void setListeners(SerialMessageListener* listeners[], uint8_t count) {
 			m_listeners = listeners;
+			m_listenersCount = count;
 		}
 
 		int16_t readByte();
@@ -51,6 +51,17 @@ public:
 
     /** Broadcast device address */
     static const uint8_t BROADCAST = 0x00;
+
+    /**
+     * Driver capabilities; see get_capabilities().
+     */
+    struct capabilities_t {
+      uint8_t payload_max;	/**< max payload per message, 0 if unknown */
+      bool broadcast;		/**< BROADCAST destination supported */
+      bool rssi;		/**< get_input_power_level() is measured */
+      bool lqi;			/**< get_link_quality_indicator() is measured */
+      bool retransmits;		/**< get_retransmit_count() is measured */
+    };
     
   protected:
     /** Current channel */
@@ -310,6 +321,32 @@ public:
     {
       return (0);
     }
+
+    /**
+     * @override Wireless::Driver
+     * Return number of retransmissions of the last sent message.
+     * Default zero(0).
+     */
+    virtual int get_retransmit_count()
+    {
+      return (0);
+    }
+
+    /**
+     * @override Wireless::Driver
+     * Return driver capabilities. Default unknown payload size,
+     * broadcast, no input power level, no link quality indicator
+     * and no retransmission count.
+     * @param[out] caps capabilities.
+     */
+    virtual void get_capabilities(capabilities_t& caps)
+    {
+      caps.payload_max = 0;
+      caps.broadcast = true;
+      caps.rssi = false;
+      caps.lqi = false;
+      caps.retransmits = false;
+    }
   };
 };
 #endif
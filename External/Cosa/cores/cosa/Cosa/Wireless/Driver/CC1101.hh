@@ -652,6 +652,20 @@ public:
    */
   virtual void set_output_power_level(int8_t dBm);
 
+  /**
+   * @override Wireless::Driver
+   * Return driver capabilities.
+   * @param[out] caps capabilities.
+   */
+  virtual void get_capabilities(capabilities_t& caps)
+  {
+    caps.payload_max = PAYLOAD_MAX;
+    caps.broadcast = true;
+    caps.rssi = true;
+    caps.lqi = true;
+    caps.retransmits = false;
+  }
+
   /**
    * @override Wireless::Driver
    * Return estimated input power level (dBm) from latest successful
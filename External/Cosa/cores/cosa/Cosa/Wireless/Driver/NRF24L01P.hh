@@ -634,6 +634,30 @@ public:
 		   void* buf, size_t count, 
 		   uint32_t ms = 0L);
 
+  /**
+   * @override Wireless::Driver
+   * Return driver capabilities.
+   * @param[out] caps capabilities.
+   */
+  virtual void get_capabilities(capabilities_t& caps)
+  {
+    caps.payload_max = PAYLOAD_MAX;
+    caps.broadcast = true;
+    caps.rssi = false;
+    caps.lqi = false;
+    caps.retransmits = true;
+  }
+
+  /**
+   * @override Wireless::Driver
+   * Return number of retransmissions of the last sent message;
+   * the auto retransmit count when it was not acknowledged.
+   */
+  virtual int get_retransmit_count()
+  {
+    return (read_observe_tx().arc_cnt);
+  }
+
   /**
    * @override Wireless::Driver
    * Set output power level (-30..10 dBm)
@@ -524,5 +524,19 @@ public:
   {
     return (m_rx.recv(src, port, buf, len, ms));
   }
+
+  /**
+   * @override Wireless::Driver
+   * Return driver capabilities.
+   * @param[out] caps capabilities.
+   */
+  virtual void get_capabilities(capabilities_t& caps)
+  {
+    caps.payload_max = PAYLOAD_MAX - sizeof(header_t);
+    caps.broadcast = true;
+    caps.rssi = false;
+    caps.lqi = false;
+    caps.retransmits = false;
+  }
 };
 #endif